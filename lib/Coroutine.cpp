@@ -0,0 +1,72 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/Coroutine.h"
+
+namespace rtb {
+namespace Concurrency {
+
+    Task::Task(Task &&other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    Task::~Task() {
+        if (handle_) handle_.destroy();
+    }
+
+    void Task::FinalAwaiter::await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+        // the frame is released before `join` can return
+        Scheduler *scheduler{ handle.promise().scheduler };
+        handle.destroy();
+        scheduler->taskDone();
+    }
+
+    Scheduler::Scheduler(size_t threads)
+        : dispatcher_(threads) {}
+
+    Scheduler::~Scheduler() {
+        join();
+    }
+
+    void Scheduler::spawn(Task task) {
+        auto handle{ std::exchange(task.handle_, nullptr) };
+        handle.promise().scheduler = this;
+        std::unique_lock<std::mutex> mlock(mutex_);
+        ++tasks_;
+        mlock.unlock();
+        resume(handle);
+    }
+
+    void Scheduler::post(void (*work)(void *), void *arg) {
+        dispatcher_.post(work, arg);
+    }
+
+    void Scheduler::resume(std::coroutine_handle<> handle) {
+        post([](void *address) { std::coroutine_handle<>::from_address(address).resume(); },
+            handle.address());
+    }
+
+    void Scheduler::join() {
+        std::unique_lock<std::mutex> mlock(mutex_);
+        noTasks_.wait(mlock, [this]() { return tasks_ == 0; });
+        mlock.unlock();
+        dispatcher_.join();
+    }
+
+    void Scheduler::taskDone() {
+        std::lock_guard<std::mutex> guard{ mutex_ };
+        if (--tasks_ == 0) noTasks_.notify_all();
+    }
+
+}// namespace Concurrency
+}// namespace rtb
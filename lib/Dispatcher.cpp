@@ -0,0 +1,48 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/Dispatcher.h"
+
+namespace rtb {
+namespace Concurrency {
+
+    Dispatcher::Dispatcher(size_t threads) {
+        for (size_t i{ 0 }; i < threads; ++i)
+            threads_.emplace_back(&Dispatcher::run, this);
+    }
+
+    Dispatcher::~Dispatcher() {
+        join();
+    }
+
+    void Dispatcher::post(void (*work)(void *), void *arg) {
+        work_.push(Work{ work, arg });
+    }
+
+    void Dispatcher::join() {
+        // each thread consumes one end of stream
+        for (size_t i{ 0 }; i < threads_.size(); ++i)
+            work_.close();
+        for (auto &it : threads_)
+            it.join();
+        threads_.clear();
+    }
+
+    void Dispatcher::run() {
+        while (auto work{ work_.pop() })
+            work->run(work->arg);
+    }
+
+}// namespace Concurrency
+}// namespace rtb
@@ -0,0 +1,31 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/EventCount.h"
+
+namespace rtb {
+namespace Concurrency {
+
+    void EventCount::notifyAll() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) == 0) return;
+        // a waiter that has been counted is either already parked or still holds the mutex
+        // before parking. Taking the mutex here makes sure the notification is not lost
+        std::unique_lock<std::mutex> mlock(mutex_);
+        mlock.unlock();
+        cond_.notify_all();
+    }
+
+}// namespace Concurrency
+}// namespace rtb
@@ -0,0 +1,114 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/MappedFile.h"
+#include <cerrno>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rtb {
+namespace Concurrency {
+
+    namespace {
+        [[noreturn]] void throwSystemError(const std::string &what) {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        // an empty file cannot be mapped, so it has no mapping at all
+        void *map(int fd, std::size_t size, bool writable) {
+            if (size == 0) return nullptr;
+            const int protection{ writable ? PROT_READ | PROT_WRITE : PROT_READ };
+            void *data{ mmap(nullptr, size, protection, MAP_SHARED, fd, 0) };
+            return data == MAP_FAILED ? nullptr : data;
+        }
+    }// namespace
+
+    MappedFile MappedFile::create(const std::string &path, std::size_t size) {
+        int fd{ ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644) };
+        if (fd == -1) throwSystemError("MappedFile: cannot create " + path);
+        MappedFile file(fd, nullptr, 0, true);
+        file.resize(size);
+        return file;
+    }
+
+    MappedFile MappedFile::open(const std::string &path) {
+        int fd{ ::open(path.c_str(), O_RDONLY) };
+        if (fd == -1) throwSystemError("MappedFile: cannot open " + path);
+        MappedFile file(fd, nullptr, 0, false);
+        struct stat info;
+        if (fstat(fd, &info) == -1) throwSystemError("MappedFile: cannot read the size of " + path);
+        file.size_ = static_cast<std::size_t>(info.st_size);
+        file.data_ = map(fd, file.size_, false);
+        if (file.size_ > 0 && !file.data_) throwSystemError("MappedFile: cannot map " + path);
+        return file;
+    }
+
+    MappedFile::MappedFile(int fd, void *data, std::size_t size, bool writable)
+        : fd_(fd)
+        , data_(data)
+        , size_(size)
+        , writable_(writable) {}
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept
+        : fd_(other.fd_)
+        , data_(other.data_)
+        , size_(other.size_)
+        , writable_(other.writable_) {
+        other.fd_ = -1;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+        if (this == &other) return *this;
+        release();
+        fd_ = other.fd_;
+        data_ = other.data_;
+        size_ = other.size_;
+        writable_ = other.writable_;
+        other.fd_ = -1;
+        other.data_ = nullptr;
+        other.size_ = 0;
+        return *this;
+    }
+
+    MappedFile::~MappedFile() {
+        release();
+    }
+
+    void MappedFile::resize(std::size_t size) {
+        if (!writable_)
+            throw std::system_error(EBADF, std::generic_category(), "MappedFile: read-only");
+        if (data_) munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+        if (ftruncate(fd_, static_cast<off_t>(size)) == -1)
+            throwSystemError("MappedFile: cannot resize");
+        data_ = map(fd_, size, true);
+        if (size > 0 && !data_) throwSystemError("MappedFile: cannot map");
+        size_ = size;
+    }
+
+    void MappedFile::release() {
+        if (data_) munmap(data_, size_);
+        if (fd_ != -1) ::close(fd_);
+        data_ = nullptr;
+        fd_ = -1;
+    }
+
+}// namespace Concurrency
+}// namespace rtb
@@ -0,0 +1,61 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/Selector.h"
+
+namespace rtb {
+namespace Concurrency {
+
+    Selector::~Selector() {
+        for (auto &it : sources_)
+            it.detach(it.source, *this);
+    }
+
+    size_t Selector::wait() {
+        while (true) {
+            // read before scanning, so that a push after the scan is not missed
+            const auto seen{ notifications() };
+            if (auto ready{ findReady() }) return *ready;
+            std::unique_lock<std::mutex> mlock(mutex_);
+            waiting_ = true;
+            cond_.wait(mlock, [this, seen]() { return notifications_ != seen; });
+            waiting_ = false;
+        }
+    }
+
+    bool Selector::notify() {
+        std::lock_guard<std::mutex> guard{ mutex_ };
+        ++notifications_;
+        if (waiting_) cond_.notify_one();
+        return true;
+    }
+
+    std::optional<size_t> Selector::findReady() {
+        for (size_t i{ 0 }; i < sources_.size(); ++i) {
+            const size_t index{ (next_ + i) % sources_.size() };
+            if (sources_[index].ready(sources_[index].source)) {
+                next_ = index + 1;
+                return index;
+            }
+        }
+        return std::nullopt;
+    }
+
+    unsigned long long Selector::notifications() {
+        std::lock_guard<std::mutex> guard{ mutex_ };
+        return notifications_;
+    }
+
+}// namespace Concurrency
+}// namespace rtb
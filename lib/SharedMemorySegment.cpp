@@ -0,0 +1,189 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/SharedMemorySegment.h"
+#include <cerrno>
+#include <system_error>
+#include <utility>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rtb {
+namespace Concurrency {
+
+    namespace {
+        [[noreturn]] void throwSystemError(const std::string &what) {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        void *map(int fd, std::size_t size, const std::string &name) {
+            void *data{ mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) };
+            if (data == MAP_FAILED) {
+                const int error{ errno };
+                close(fd);
+                errno = error;
+                throwSystemError("SharedMemorySegment: cannot map " + name);
+            }
+            // the mapping keeps the segment alive
+            close(fd);
+            return data;
+        }
+    }// namespace
+
+    SharedMemorySegment SharedMemorySegment::create(const std::string &name, std::size_t size) {
+        int fd{ shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600) };
+        if (fd == -1) throwSystemError("SharedMemorySegment: cannot create " + name);
+        if (ftruncate(fd, static_cast<off_t>(size)) == -1) {
+            const int error{ errno };
+            close(fd);
+            shm_unlink(name.c_str());
+            errno = error;
+            throwSystemError("SharedMemorySegment: cannot resize " + name);
+        }
+        void *data;
+        try {
+            data = map(fd, size, name);
+        } catch (...) {
+            shm_unlink(name.c_str());
+            throw;
+        }
+        return SharedMemorySegment(name, data, size, true);
+    }
+
+    SharedMemorySegment SharedMemorySegment::open(const std::string &name) {
+        int fd{ shm_open(name.c_str(), O_RDWR, 0600) };
+        if (fd == -1) throwSystemError("SharedMemorySegment: cannot open " + name);
+        struct stat info;
+        if (fstat(fd, &info) == -1) {
+            const int error{ errno };
+            close(fd);
+            errno = error;
+            throwSystemError("SharedMemorySegment: cannot read the size of " + name);
+        }
+        const auto size{ static_cast<std::size_t>(info.st_size) };
+        return SharedMemorySegment(name, map(fd, size, name), size, false);
+    }
+
+    bool SharedMemorySegment::remove(const std::string &name) {
+        if (shm_unlink(name.c_str()) == 0) return true;
+        if (errno == ENOENT) return false;
+        throwSystemError("SharedMemorySegment: cannot remove " + name);
+    }
+
+    SharedMemorySegment::SharedMemorySegment(std::string name,
+        void *data,
+        std::size_t size,
+        bool owner)
+        : name_(std::move(name))
+        , data_(data)
+        , size_(size)
+        , owner_(owner) {}
+
+    SharedMemorySegment::SharedMemorySegment(SharedMemorySegment &&other) noexcept
+        : name_(std::move(other.name_))
+        , data_(other.data_)
+        , size_(other.size_)
+        , owner_(other.owner_) {
+        other.data_ = nullptr;
+        other.owner_ = false;
+    }
+
+    SharedMemorySegment &SharedMemorySegment::operator=(SharedMemorySegment &&other) noexcept {
+        if (this == &other) return *this;
+        release();
+        name_ = std::move(other.name_);
+        data_ = other.data_;
+        size_ = other.size_;
+        owner_ = other.owner_;
+        other.data_ = nullptr;
+        other.owner_ = false;
+        return *this;
+    }
+
+    SharedMemorySegment::~SharedMemorySegment() {
+        release();
+    }
+
+    void SharedMemorySegment::release() {
+        if (data_) munmap(data_, size_);
+        if (owner_) shm_unlink(name_.c_str());
+        data_ = nullptr;
+        owner_ = false;
+    }
+
+    void initProcessShared(pthread_mutex_t &mutex) {
+        pthread_mutexattr_t attributes;
+        pthread_mutexattr_init(&attributes);
+        pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+        const int error{ pthread_mutex_init(&mutex, &attributes) };
+        pthread_mutexattr_destroy(&attributes);
+        if (error != 0)
+            throw std::system_error(error, std::generic_category(), "initProcessShared: mutex");
+    }
+
+    void initProcessShared(pthread_cond_t &cond) {
+        pthread_condattr_t attributes;
+        pthread_condattr_init(&attributes);
+        pthread_condattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+        pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+        const int error{ pthread_cond_init(&cond, &attributes) };
+        pthread_condattr_destroy(&attributes);
+        if (error != 0)
+            throw std::system_error(
+                error, std::generic_category(), "initProcessShared: condition variable");
+    }
+
+    namespace {
+        // a previous owner died holding the mutex: the data it protects is kept as it is
+        void checkLocked(pthread_mutex_t &mutex, int error) {
+            if (error == EOWNERDEAD)
+                pthread_mutex_consistent(&mutex);
+            else if (error != 0)
+                throw std::system_error(error, std::generic_category(), "ProcessLock");
+        }
+    }// namespace
+
+    ProcessLock::ProcessLock(pthread_mutex_t &mutex)
+        : mutex_(mutex) {
+        checkLocked(mutex_, pthread_mutex_lock(&mutex_));
+    }
+
+    ProcessLock::~ProcessLock() {
+        pthread_mutex_unlock(&mutex_);
+    }
+
+    void ProcessLock::wait(pthread_cond_t &cond) {
+        checkLocked(mutex_, pthread_cond_wait(&cond, &mutex_));
+    }
+
+    bool ProcessLock::waitUntil(pthread_cond_t &cond,
+        const std::chrono::steady_clock::time_point &deadline) {
+        // `steady_clock` is `CLOCK_MONOTONIC`, the clock of the condition variables
+        const auto sinceEpoch{ std::chrono::duration_cast<std::chrono::nanoseconds>(
+            deadline.time_since_epoch()) };
+        timespec time;
+        time.tv_sec = static_cast<time_t>(sinceEpoch.count() / 1000000000);
+        time.tv_nsec = static_cast<long>(sinceEpoch.count() % 1000000000);
+        const int error{ pthread_cond_timedwait(&cond, &mutex_, &time) };
+        if (error == ETIMEDOUT) return false;
+        checkLocked(mutex_, error);
+        return true;
+    }
+
+}// namespace Concurrency
+}// namespace rtb
@@ -0,0 +1,38 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/WaitStrategy.h"
+
+namespace rtb {
+namespace Concurrency {
+
+    void SpinThenParkWait::notifyOne() {
+        SpinningWait<BusyRelax>::notifyAll();
+        // the state change has been made with the lock held, after any parked thread had
+        // released it while waiting, so its registration is visible here
+        if (parked_.load(std::memory_order_relaxed) > 0) cond_.notify_one();
+    }
+
+    void SpinThenParkWait::notifyAll() {
+        SpinningWait<BusyRelax>::notifyAll();
+        if (parked_.load(std::memory_order_relaxed) > 0) cond_.notify_all();
+    }
+
+    bool SpinThenParkWait::spin(std::unique_lock<std::mutex> &lock) {
+        unsigned polls{ 0 };
+        return awaitNotification(lock, [&polls]() { return ++polls >= SpinCount; });
+    }
+
+}// namespace Concurrency
+}// namespace rtb
@@ -0,0 +1,105 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/WorkerPool.h"
+
+namespace rtb {
+namespace Concurrency {
+
+    WorkerPool::WorkerPool(std::size_t threads)
+        : idle_(0)
+        , starting_(0)
+        , stopping_(false) {
+        std::lock_guard<std::mutex> mlock(mutex_);
+        for (std::size_t i{ 0 }; i < threads; ++i)
+            spawn();
+    }
+
+    WorkerPool::~WorkerPool() {
+        join();
+    }
+
+    void WorkerPool::post(void (*work)(void *), void *arg) {
+        std::unique_lock<std::mutex> mlock(mutex_);
+        work_.push_back(Work{ work, arg });
+        // each idle or starting thread takes one piece of work, the others need a new thread
+        if (work_.size() > idle_ + starting_)
+            spawn();
+        mlock.unlock();
+        cond_.notify_one();
+    }
+
+    void WorkerPool::join() {
+        std::unique_lock<std::mutex> mlock(mutex_);
+        stopping_ = true;
+        mlock.unlock();
+        cond_.notify_all();
+        // no thread is added once `stopping_` is set and the queued work has run
+        for (auto &it : threads_)
+            it.join();
+        threads_.clear();
+    }
+
+    std::size_t WorkerPool::size() const {
+        std::lock_guard<std::mutex> mlock(mutex_);
+        return threads_.size();
+    }
+
+    std::size_t WorkerPool::idle() const {
+        std::lock_guard<std::mutex> mlock(mutex_);
+        return idle_;
+    }
+
+    void WorkerPool::spawn() {
+        ++starting_;
+        threads_.emplace_back(&WorkerPool::run, this);
+    }
+
+    void WorkerPool::run() {
+        std::unique_lock<std::mutex> mlock(mutex_);
+        --starting_;
+        while (true) {
+            ++idle_;
+            cond_.wait(mlock, [this]() { return !work_.empty() || stopping_; });
+            --idle_;
+            if (work_.empty()) return;
+            Work work{ work_.front() };
+            work_.pop_front();
+            mlock.unlock();
+            work.run(work.arg);
+            mlock.lock();
+        }
+    }
+
+    WaitGroup::WaitGroup(std::size_t count)
+        : count_(count) {}
+
+    void WaitGroup::add(std::size_t count) {
+        std::lock_guard<std::mutex> mlock(mutex_);
+        count_ += count;
+    }
+
+    void WaitGroup::done() {
+        std::lock_guard<std::mutex> mlock(mutex_);
+        if (--count_ == 0)
+            cond_.notify_all();
+    }
+
+    void WaitGroup::wait() {
+        std::unique_lock<std::mutex> mlock(mutex_);
+        cond_.wait(mlock, [this]() { return count_ == 0; });
+    }
+
+}// namespace Concurrency
+}// namespace rtb
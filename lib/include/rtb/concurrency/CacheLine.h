@@ -0,0 +1,30 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_CacheLine_h
+#define rtb_CacheLine_h
+
+#include <cstddef>
+
+namespace rtb {
+namespace Concurrency {
+    // Alignment used to keep data written by different threads on separate cache lines.
+    // `std::hardware_destructive_interference_size` is not available on all the supported
+    // compilers, 64 bytes is correct for x86-64 and most ARM cores.
+    constexpr std::size_t CacheLineSize = 64;
+}// namespace Concurrency
+}// namespace rtb
+
+#endif
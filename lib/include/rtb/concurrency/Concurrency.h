@@ -16,8 +16,14 @@
 #ifndef rtb_Concurrency_h
 #define rtb_Concurrency_h
 
+#include "rtb/concurrency/Dispatcher.h"
 #include "rtb/concurrency/Latch.h"
+#include "rtb/concurrency/LatestValue.h"
 #include "rtb/concurrency/Queue.h"
+#include "rtb/concurrency/RingQueue.h"
+#include "rtb/concurrency/Selector.h"
+#include "rtb/concurrency/SharedQueue.h"
 #include "rtb/concurrency/ThreadPool.h"
+#include "rtb/concurrency/WorkerPool.h"
 
 #endif
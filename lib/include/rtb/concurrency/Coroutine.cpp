@@ -0,0 +1,88 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+namespace rtb {
+namespace Concurrency {
+
+    template<typename Source>
+    bool PopAwaiter<Source>::await_ready() {
+        result_ = source_.tryPop(item_);
+        return result_ != PopResult::Timeout;
+    }
+
+    template<typename Source>
+    void PopAwaiter<Source>::await_suspend(std::coroutine_handle<Task::promise_type> handle) {
+        handle_ = handle;
+        scheduler_ = handle.promise().scheduler;
+        // the task can be resumed by another thread before `attach` returns, so the awaiter
+        // must not be used after this call
+        source_.attach(*this);
+    }
+
+    template<typename Source>
+    std::optional<typename PopAwaiter<Source>::type> PopAwaiter<Source>::await_resume() {
+        if (result_ != PopResult::Ok) return std::nullopt;
+        return std::move(item_);
+    }
+
+    template<typename Source>
+    bool PopAwaiter<Source>::notify() {
+        // called with the lock of the source held, the pop is retried on the scheduler
+        scheduler_->post(&PopAwaiter::retry, this);
+        return false;
+    }
+
+    template<typename Source>
+    void PopAwaiter<Source>::retry(void *awaiter) {
+        auto &me{ *static_cast<PopAwaiter *>(awaiter) };
+        me.result_ = me.source_.tryPop(me.item_);
+        // another consumer of a `SimpleQueue` can take the message first
+        if (me.result_ == PopResult::Timeout)
+            me.source_.attach(me);
+        else
+            me.handle_.resume();
+    }
+
+    template<typename T, typename WaitStrategy>
+    void PushAwaiter<T, WaitStrategy>::await_suspend(
+        std::coroutine_handle<Task::promise_type> handle) {
+        handle_ = handle;
+        scheduler_ = handle.promise().scheduler;
+        queue_.attachProducer(*this);
+    }
+
+    template<typename T, typename WaitStrategy>
+    bool PushAwaiter<T, WaitStrategy>::tryPush() {
+        return item_ ? queue_.tryPush(std::move(item_.value())) : queue_.tryClose();
+    }
+
+    template<typename T, typename WaitStrategy>
+    bool PushAwaiter<T, WaitStrategy>::notify() {
+        scheduler_->post(&PushAwaiter::retry, this);
+        return false;
+    }
+
+    template<typename T, typename WaitStrategy>
+    void PushAwaiter<T, WaitStrategy>::retry(void *awaiter) {
+        auto &me{ *static_cast<PushAwaiter *>(awaiter) };
+        // other producers can fill the queue again first
+        if (me.tryPush())
+            me.handle_.resume();
+        else
+            me.queue_.attachProducer(me);
+    }
+
+}// namespace Concurrency
+}// namespace rtb
@@ -0,0 +1,190 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_Coroutine_h
+#define rtb_Coroutine_h
+
+#ifndef __cpp_impl_coroutine
+#error "Coroutine.h needs C++20, configure the library with CONCURRENCY_ENABLE_COROUTINES=ON"
+#endif
+
+#include <coroutine>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include "rtb/concurrency/Dispatcher.h"
+#include "rtb/concurrency/Listener.h"
+#include "rtb/concurrency/PopResult.h"
+#include "rtb/concurrency/Queue.h"
+#include "rtb/concurrency/SimpleQueue.h"
+
+namespace rtb {
+namespace Concurrency {
+    class Scheduler;
+
+    //   Task - a coroutine run by a `Scheduler`, e.g., a stage of a pipeline
+    //            Task addOne(Queue<int>::Subscription &in, SimpleQueue<int> &out) {
+    //                while (auto val{ co_await popAsync(in) })
+    //                    co_await pushAsync(out, val.value() + 1);
+    //                out.close();
+    //            }
+    //            scheduler.spawn(addOne(subscription, out));
+    //          The task starts when it is spawned, and its frame is released when it returns.
+    //          An exception escaping the task terminates the program.
+    class Task {
+      public:
+        struct promise_type;
+
+        Task(Task &&other) noexcept;
+        Task(const Task &) = delete;
+        Task &operator=(const Task &) = delete;
+        Task &operator=(Task &&) = delete;
+        // destroys the coroutine if it has not been spawned
+        ~Task();
+
+      private:
+        friend class Scheduler;
+        // releases the frame, then tells the scheduler that the task is over
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            void await_suspend(std::coroutine_handle<promise_type> handle) noexcept;
+            void await_resume() noexcept {}
+        };
+        explicit Task(std::coroutine_handle<promise_type> handle)
+            : handle_(handle) {}
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+    struct Task::promise_type {
+        Task get_return_object() {
+            return Task{ std::coroutine_handle<promise_type>::from_promise(*this) };
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+        Scheduler *scheduler{ nullptr };
+    };
+
+    //   Scheduler - runs `Task`s on a fixed set of threads. A task waiting on a queue through
+    //               `popAsync` or `pushAsync` does not hold a thread: it is suspended, and
+    //               resumed on one of the scheduler threads when the queue can satisfy it, so
+    //               hundreds of stages can share a few threads.
+    class Scheduler {
+      public:
+        explicit Scheduler(size_t threads = 1);
+        Scheduler(const Scheduler &) = delete;
+        Scheduler &operator=(const Scheduler &) = delete;
+        // calls `join`
+        ~Scheduler();
+        void spawn(Task task);
+        // runs `work(arg)` on one of the scheduler threads
+        void post(void (*work)(void *), void *arg);
+        void resume(std::coroutine_handle<> handle);
+        // waits until all the spawned tasks have returned, then stops the threads
+        void join();
+
+      private:
+        friend struct Task::FinalAwaiter;
+        void taskDone();
+        Dispatcher dispatcher_;
+        std::mutex mutex_;
+        std::condition_variable noTasks_;
+        // spawned tasks that have not returned yet
+        size_t tasks_{ 0 };
+    };
+
+    // Awaiter returned by `popAsync`. When the source is empty the task is suspended and the
+    // awaiter is attached to the source as a `Listener`, the source notifies it when a message
+    // arrives and the task is resumed on the scheduler
+    template<typename Source>
+    class PopAwaiter : public Listener {
+      public:
+        typedef typename Source::type type;
+
+        explicit PopAwaiter(Source &source)
+            : source_(source) {}
+        bool await_ready();
+        void await_suspend(std::coroutine_handle<Task::promise_type> handle);
+        // returns no value when the source has been closed
+        std::optional<type> await_resume();
+        bool notify() override;
+
+      private:
+        static void retry(void *awaiter);
+        Source &source_;
+        // the sources fill an optional, so `type` needs no default constructor
+        std::optional<type> item_;
+        PopResult result_{ PopResult::Timeout };
+        std::coroutine_handle<> handle_;
+        Scheduler *scheduler_{ nullptr };
+    };
+
+    // Awaiter returned by `pushAsync` and `closeAsync` on a `Queue`, it suspends the task while
+    // a bounded queue is full and a lagging subscriber blocks it
+    template<typename T, typename WaitStrategy>
+    class PushAwaiter : public Listener {
+      public:
+        // no `item` closes the queue
+        PushAwaiter(Queue<T, WaitStrategy> &queue, std::optional<T> item)
+            : queue_(queue)
+            , item_(std::move(item)) {}
+        bool await_ready() { return tryPush(); }
+        void await_suspend(std::coroutine_handle<Task::promise_type> handle);
+        void await_resume() {}
+        bool notify() override;
+
+      private:
+        bool tryPush();
+        static void retry(void *awaiter);
+        Queue<T, WaitStrategy> &queue_;
+        std::optional<T> item_;
+        std::coroutine_handle<> handle_;
+        Scheduler *scheduler_{ nullptr };
+    };
+
+    // `co_await popAsync(source)` pops from a `Queue<T>::Subscription` or a `SimpleQueue<T>`
+    // from a `Task`, without blocking the thread
+    template<typename Source>
+    PopAwaiter<Source> popAsync(Source &source) {
+        return PopAwaiter<Source>{ source };
+    }
+
+    template<typename T, typename WaitStrategy>
+    PushAwaiter<T, WaitStrategy> pushAsync(Queue<T, WaitStrategy> &queue,
+        std::type_identity_t<T> item) {
+        return PushAwaiter<T, WaitStrategy>{ queue, std::move(item) };
+    }
+
+    // `Queue::close` can wait for room too, so a task closes a bounded queue with
+    // `co_await closeAsync(queue)`
+    template<typename T, typename WaitStrategy>
+    PushAwaiter<T, WaitStrategy> closeAsync(Queue<T, WaitStrategy> &queue) {
+        return PushAwaiter<T, WaitStrategy>{ queue, std::nullopt };
+    }
+
+    // a `SimpleQueue` is unbounded, so the push never suspends the task
+    template<typename T, typename QueueType, typename WaitStrategy>
+    std::suspend_never pushAsync(SimpleQueue<T, QueueType, WaitStrategy> &queue,
+        std::type_identity_t<T> item) {
+        queue.push(std::move(item));
+        return {};
+    }
+}// namespace Concurrency
+}// namespace rtb
+
+#include "Coroutine.cpp"
+#endif
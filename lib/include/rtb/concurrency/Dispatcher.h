@@ -0,0 +1,53 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_Dispatcher_h
+#define rtb_Dispatcher_h
+
+#include <thread>
+#include <vector>
+#include "rtb/concurrency/SimpleQueue.h"
+
+namespace rtb {
+namespace Concurrency {
+    //   Dispatcher - a fixed set of threads running the work posted to it, in the order it has
+    //                been posted. It is shared by the consumers that do little work for each
+    //                message (see `Queue::subscribe(handler, dispatcher)`), so that they do not
+    //                need a thread each.
+    class Dispatcher {
+      public:
+        explicit Dispatcher(size_t threads = 1);
+        Dispatcher(const Dispatcher &) = delete;
+        Dispatcher &operator=(const Dispatcher &) = delete;
+        // calls `join`
+        ~Dispatcher();
+        // runs `work(arg)` on one of the threads
+        void post(void (*work)(void *), void *arg);
+        // runs the work posted so far, then stops the threads. Nothing can be posted afterwards
+        void join();
+
+      private:
+        struct Work {
+            void (*run)(void *);
+            void *arg;
+        };
+        void run();
+        SimpleQueue<Work> work_;
+        std::vector<std::thread> threads_;
+    };
+}// namespace Concurrency
+}// namespace rtb
+
+#endif
@@ -0,0 +1,90 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_EventCount_h
+#define rtb_EventCount_h
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+
+namespace rtb {
+namespace Concurrency {
+    //   EventCount - lets the lock-free containers block a thread until a condition on their
+    //                atomic state becomes true.
+    //                The waiting thread spins for a short while and then parks on a condition
+    //                variable. The notifying thread only touches the mutex when somebody is
+    //                actually parked, so the fast path of a push or a pop stays lock-free.
+    class EventCount {
+      public:
+        EventCount() = default;
+        EventCount(const EventCount &) = delete;
+        EventCount &operator=(const EventCount &) = delete;
+        // Blocks until `condition()` returns true. `condition` must only read atomic state, and
+        // whoever makes it true must call `notifyAll` afterwards
+        template<typename Predicate>
+        void wait(Predicate condition);
+        // As `wait`, but gives up at `deadline`. Returns the last value of `condition()`
+        template<typename Predicate, typename Clock, typename Duration>
+        bool waitUntil(const std::chrono::time_point<Clock, Duration> &deadline,
+            Predicate condition);
+        // Wakes all the parked threads. Costs a fence and an atomic load when nobody is parked
+        void notifyAll();
+
+      private:
+        static constexpr unsigned SpinCount = 64;
+        std::atomic<unsigned> waiters_{ 0 };
+        std::mutex mutex_;
+        std::condition_variable cond_;
+    };
+
+    template<typename Predicate>
+    void EventCount::wait(Predicate condition) {
+        for (unsigned i{ 0 }; i < SpinCount; ++i) {
+            if (condition()) return;
+        }
+        std::unique_lock<std::mutex> mlock(mutex_);
+        waiters_.fetch_add(1, std::memory_order_relaxed);
+        // pairs with the fence in `notifyAll`: either we see the new state or the notifier
+        // sees us waiting
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!condition()) {
+            cond_.wait(mlock);
+        }
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    template<typename Predicate, typename Clock, typename Duration>
+    bool EventCount::waitUntil(const std::chrono::time_point<Clock, Duration> &deadline,
+        Predicate condition) {
+        for (unsigned i{ 0 }; i < SpinCount; ++i) {
+            if (condition()) return true;
+        }
+        std::unique_lock<std::mutex> mlock(mutex_);
+        waiters_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool ready = condition();
+        while (!ready && cond_.wait_until(mlock, deadline) != std::cv_status::timeout) {
+            ready = condition();
+        }
+        if (!ready) ready = condition();
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+        return ready;
+    }
+}// namespace Concurrency
+}// namespace rtb
+
+#endif
@@ -12,28 +12,27 @@
  * See the License for the specific language governing permissions and        *
  * limitations under the License.                                             *
  * -------------------------------------------------------------------------- */
-#include "rtb/concurrency/Latch.h"
+#include <cstdlib>
 #include <iostream>
-#include <algorithm>
-
-#include <iostream>
-#include <algorithm>
-
+#include <stdexcept>
 
 namespace rtb{
     namespace Concurrency{
 
-        Latch::Latch()
+        template<typename WaitStrategy>
+        BasicLatch<WaitStrategy>::BasicLatch()
             :count_(0)
         { }
 
 
-        Latch::Latch(int count)
+        template<typename WaitStrategy>
+        BasicLatch<WaitStrategy>::BasicLatch(int count)
             : count_(count)
         { }
 
 
-        void Latch::setCount(int count)
+        template<typename WaitStrategy>
+        void BasicLatch<WaitStrategy>::setCount(int count)
         {
             if (count_ != 0) {
                 std::cout << "You are not allowed to reset a Latch\n";
@@ -44,24 +43,24 @@ namespace rtb{
         }
 
 
-		void Latch::increaseCount(unsigned n)
+		template<typename WaitStrategy>
+		void BasicLatch<WaitStrategy>::increaseCount(unsigned n)
 		{
 			std::unique_lock<std::mutex> mlock(mutex_);
 			count_ += n;
 			mlock.unlock();
 		}
 
-        void Latch::wait() {
+        template<typename WaitStrategy>
+        void BasicLatch<WaitStrategy>::wait() {
             std::unique_lock<std::mutex> mlock(mutex_);
             if (count_ == 0) {
                 throw std::logic_error("internal count == 0");
             }
             if (--count_ == 0)
-                condition_.notify_all();
-            else {
-                while (count_ > 0)
-                    condition_.wait(mlock);
-            }
+                condition_.notifyAll();
+            else
+                condition_.wait(mlock, [this]() { return count_ <= 0; });
             mlock.unlock();
         }
     }
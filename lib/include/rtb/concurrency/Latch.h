@@ -17,29 +17,35 @@
 
 #include <thread>
 #include <mutex>
-#include <condition_variable>
+#include "rtb/concurrency/WaitStrategy.h"
 
 namespace rtb{
     namespace Concurrency{
-        class Latch {
+        // `WaitStrategy` decides how the threads wait for the count to reach zero, see
+        // WaitStrategy.h, or any class with the same interface
+        template<typename WaitStrategy>
+        class BasicLatch {
         public:
-            Latch();
-            Latch(int count);
+            BasicLatch();
+            BasicLatch(int count);
             void setCount(int count);
 			//increase the internal counter by `n`. This can be used
 			//when the number of threads that use this latch is determined
 			//at run time.
 			void increaseCount(unsigned n);
             void wait();
-            Latch(const Latch&) = delete;
-            Latch& operator=(const Latch&) = delete;
+            BasicLatch(const BasicLatch&) = delete;
+            BasicLatch& operator=(const BasicLatch&) = delete;
         private:
             int count_;
-            std::condition_variable condition_;
+            WaitStrategy condition_;
             std::mutex mutex_;
 
         };
+
+        using Latch = BasicLatch<BlockingWait>;
     }
 }
 
+#include "Latch.cpp"
 #endif
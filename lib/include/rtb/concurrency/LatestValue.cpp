@@ -0,0 +1,96 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+namespace rtb {
+namespace Concurrency {
+
+    template<typename T>
+    std::optional<T> LatestValue<T>::pop() {
+        event_.wait([this]() { return hasNewValue() || closed_.load(std::memory_order_acquire); });
+        // `closed_` is checked first: once it is set, the last value pushed is visible
+        bool closed{ closed_.load(std::memory_order_acquire) };
+        if (closed && !hasNewValue()) return std::nullopt;
+        return take();
+    }
+
+    template<typename T>
+    PopResult LatestValue<T>::tryPop(T &item) {
+        return popUntil(item, std::chrono::steady_clock::time_point{});
+    }
+
+    template<typename T>
+    template<typename Rep, typename Period>
+    PopResult LatestValue<T>::popFor(T &item, const std::chrono::duration<Rep, Period> &timeout) {
+        return popUntil(item, std::chrono::steady_clock::now() + timeout);
+    }
+
+    template<typename T>
+    template<typename Clock, typename Duration>
+    PopResult LatestValue<T>::popUntil(T &item,
+        const std::chrono::time_point<Clock, Duration> &deadline) {
+        bool closed{ closed_.load(std::memory_order_acquire) };
+        if (!closed && !hasNewValue()) {
+            if (Clock::now() >= deadline) return PopResult::Timeout;
+            if (!event_.waitUntil(deadline, [this]() {
+                    return hasNewValue() || closed_.load(std::memory_order_acquire);
+                }))
+                return PopResult::Timeout;
+            closed = closed_.load(std::memory_order_acquire);
+        }
+        if (hasNewValue()) {
+            item = take();
+            return PopResult::Ok;
+        }
+        return closed ? PopResult::Closed : PopResult::Timeout;
+    }
+
+    template<typename T>
+    void LatestValue<T>::push(const T &item) {
+        buffers_[writeIndex_] = item;
+        publish();
+    }
+
+    template<typename T>
+    void LatestValue<T>::push(T &&item) {
+        buffers_[writeIndex_] = std::move(item);
+        publish();
+    }
+
+    template<typename T>
+    void LatestValue<T>::publish() {
+        // publish the new value and take back the buffer the consumer is not using
+        writeIndex_ = middle_.exchange(writeIndex_ | Fresh, std::memory_order_acq_rel) & IndexMask;
+        event_.notifyAll();
+    }
+
+    template<typename T>
+    void LatestValue<T>::close() {
+        closed_.store(true, std::memory_order_release);
+        event_.notifyAll();
+    }
+
+    template<typename T>
+    bool LatestValue<T>::hasNewValue() const {
+        return (middle_.load(std::memory_order_acquire) & Fresh) != 0;
+    }
+
+    template<typename T>
+    T LatestValue<T>::take() {
+        readIndex_ = middle_.exchange(readIndex_, std::memory_order_acq_rel) & IndexMask;
+        return std::move(buffers_[readIndex_].value());
+    }
+
+}// namespace Concurrency
+}// namespace rtb
@@ -0,0 +1,76 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_LatestValue_h
+#define rtb_LatestValue_h
+
+#include "rtb/concurrency/CacheLine.h"
+#include "rtb/concurrency/EventCount.h"
+#include "rtb/concurrency/PopResult.h"
+#include <atomic>
+#include <chrono>
+#include <optional>
+
+namespace rtb {
+namespace Concurrency {
+    //   LatestValue - a conflating channel between one producer and one consumer, for consumers
+    //                 that only care about the most recent message (e.g., visualisation).
+    //                 It is a triple buffer: `push` never blocks and overwrites the value the
+    //                 consumer has not read yet, `pop` returns the newest complete value without
+    //                 going through the backlog. Use one `LatestValue` for each consumer.
+    template<typename T>
+    class LatestValue {
+      public:
+        typedef T type;
+        LatestValue() = default;
+        LatestValue(const LatestValue &) = delete;
+        LatestValue &operator=(const LatestValue &) = delete;
+        // Waits for a value newer than the last one read. Returns no value when the channel has
+        // been closed and the last value has been read
+        std::optional<T> pop();
+        PopResult tryPop(T &item);
+        template<typename Rep, typename Period>
+        PopResult popFor(T &item, const std::chrono::duration<Rep, Period> &timeout);
+        template<typename Clock, typename Duration>
+        PopResult popUntil(T &item, const std::chrono::time_point<Clock, Duration> &deadline);
+        void push(const T &item);
+        void push(T &&item);
+        // Call `close` when the producer has finished producing data and it is terminating.
+        void close();
+
+      private:
+        // `middle_` holds the index of the buffer shared between producer and consumer, plus
+        // this flag when the buffer contains a value the consumer has not seen yet
+        static constexpr unsigned char Fresh = 4;
+        static constexpr unsigned char IndexMask = 3;
+        // hands the buffer just written to the consumer
+        void publish();
+        bool hasNewValue() const;
+        // the consumer swaps its buffer with the shared one, the new value must be there
+        T take();
+
+        std::optional<T> buffers_[3];
+        // the producer writes in `writeIndex_`, the consumer reads from `readIndex_`
+        alignas(CacheLineSize) unsigned char writeIndex_{ 0 };
+        alignas(CacheLineSize) unsigned char readIndex_{ 1 };
+        alignas(CacheLineSize) std::atomic<unsigned char> middle_{ 2 };
+        std::atomic<bool> closed_{ false };
+        EventCount event_;
+    };
+}// namespace Concurrency
+}// namespace rtb
+
+#include "LatestValue.cpp"
+#endif
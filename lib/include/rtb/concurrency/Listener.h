@@ -0,0 +1,36 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_Listener_h
+#define rtb_Listener_h
+
+namespace rtb {
+namespace Concurrency {
+    //   Listener - notified by a queue when one of its waits could be satisfied, i.e., when a
+    //              message can be read or when a full queue has made room. It lets a consumer
+    //              wait without blocking a thread (see `Selector` and the coroutine support).
+    //              A listener attached to a queue that can already satisfy it is notified
+    //              immediately, so there is no window in which a notification is lost.
+    class Listener {
+      public:
+        virtual ~Listener() = default;
+        // Called with the lock of the queue held, so it must not call back into the queue.
+        // Returns false to be detached from the queue
+        virtual bool notify() = 0;
+    };
+}// namespace Concurrency
+}// namespace rtb
+
+#endif
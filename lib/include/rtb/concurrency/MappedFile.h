@@ -0,0 +1,58 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_MappedFile_h
+#define rtb_MappedFile_h
+
+#include <cstddef>
+#include <string>
+
+namespace rtb {
+namespace Concurrency {
+    //   MappedFile - a file mapped in memory with `mmap`, either writable and resizable, or
+    //                read-only. Errors of the system calls are thrown as `std::system_error`.
+    class MappedFile {
+      public:
+        // Creates (or truncates) `path` with `size` bytes, mapped for reading and writing
+        static MappedFile create(const std::string &path, std::size_t size);
+        // Maps the whole content of `path` for reading
+        static MappedFile open(const std::string &path);
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+        ~MappedFile();
+
+        // Changes the size of a writable file and maps it again: pointers to the previous
+        // mapping are invalidated
+        void resize(std::size_t size);
+        unsigned char *data() { return static_cast<unsigned char *>(data_); }
+        const unsigned char *data() const { return static_cast<const unsigned char *>(data_); }
+        std::size_t size() const { return size_; }
+
+      private:
+        MappedFile(int fd, void *data, std::size_t size, bool writable);
+        void release();
+
+        int fd_{ -1 };
+        void *data_{ nullptr };
+        std::size_t size_{ 0 };
+        bool writable_{ false };
+    };
+}// namespace Concurrency
+}// namespace rtb
+
+#endif
@@ -0,0 +1,141 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_Metrics_h
+#define rtb_Metrics_h
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace rtb {
+namespace Concurrency {
+    // The metrics are collected only when `RTB_CONCURRENCY_METRICS` is defined (CMake option
+    // `CONCURRENCY_ENABLE_METRICS`). Otherwise all the counters are compiled out and the
+    // snapshots only report what is known without counting (depth and lag).
+    // The macro changes the layout of the classes, so the library and all the code using it
+    // must be built with the same setting: use the CMake option, not a per-target definition.
+#ifdef RTB_CONCURRENCY_METRICS
+    constexpr bool MetricsEnabled = true;
+#else
+    constexpr bool MetricsEnabled = false;
+#endif
+
+    // Snapshot of a `Queue` or a `SimpleQueue`
+    struct QueueMetrics {
+        std::uint64_t pushed{ 0 };
+        std::uint64_t popped{ 0 };
+        // messages currently queued, and the maximum ever queued
+        std::size_t depth{ 0 };
+        std::size_t highWaterMark{ 0 };
+        // total time spent waiting for room in `push`, and for a message in `pop`
+        std::chrono::nanoseconds pushBlocked{ 0 };
+        std::chrono::nanoseconds popBlocked{ 0 };
+        // total time spent waiting to acquire the queue lock
+        std::chrono::nanoseconds lockWait{ 0 };
+    };
+
+    // Snapshot of a `Queue` subscription
+    struct SubscriberMetrics {
+        std::uint64_t popped{ 0 };
+        // messages pushed but not read yet by the subscriber
+        std::size_t lag{ 0 };
+        std::chrono::nanoseconds popBlocked{ 0 };
+    };
+
+    // Snapshot of an `ExecutionPool`
+    struct ExecutionPoolMetrics {
+        // jobs handed to the workers, processed by them, and published in order on the output
+        std::uint64_t dispatched{ 0 };
+        std::uint64_t processed{ 0 };
+        std::uint64_t published{ 0 };
+        // total time spent by the workers in the user function
+        std::chrono::nanoseconds busy{ 0 };
+        // total time spent waiting for an out of order result before publishing it
+        std::chrono::nanoseconds reorderWait{ 0 };
+    };
+
+    //   BasicStopwatch - measures the duration of a section, and reads no clock at all when the
+    //                    metrics are disabled
+    template<bool Enabled = MetricsEnabled>
+    class BasicStopwatch {
+      public:
+        std::chrono::nanoseconds elapsed() const {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start_);
+        }
+
+      private:
+        std::chrono::steady_clock::time_point start_{ std::chrono::steady_clock::now() };
+    };
+
+    template<>
+    class BasicStopwatch<false> {
+      public:
+        std::chrono::nanoseconds elapsed() const { return std::chrono::nanoseconds{ 0 }; }
+    };
+
+    using Stopwatch = BasicStopwatch<>;
+
+    //   Counters - holds a metrics snapshot that is updated through `record`. It is not
+    //              synchronised: the owner updates and reads it with its own lock held.
+    //              When the metrics are disabled `record` does not even call `update`
+    template<typename Metrics, bool Enabled = MetricsEnabled>
+    class Counters {
+      public:
+        template<typename Update>
+        void record(Update update) {
+            update(metrics_);
+        }
+        Metrics snapshot() const { return metrics_; }
+
+      private:
+        Metrics metrics_;
+    };
+
+    template<typename Metrics>
+    class Counters<Metrics, false> {
+      public:
+        template<typename Update>
+        void record(Update) {}
+        Metrics snapshot() const { return Metrics{}; }
+    };
+
+    //   Tally - a counter that can be incremented by several threads without a lock
+    template<bool Enabled = MetricsEnabled>
+    class BasicTally {
+      public:
+        void add(std::uint64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+        void add(std::chrono::nanoseconds d) { add(static_cast<std::uint64_t>(d.count())); }
+        std::uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+      private:
+        std::atomic<std::uint64_t> value_{ 0 };
+    };
+
+    template<>
+    class BasicTally<false> {
+      public:
+        void add(std::uint64_t) {}
+        void add(std::chrono::nanoseconds) {}
+        std::uint64_t value() const { return 0; }
+    };
+
+    using Tally = BasicTally<>;
+}// namespace Concurrency
+}// namespace rtb
+
+#endif
@@ -0,0 +1,190 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include <cstdint>
+
+namespace rtb {
+namespace Concurrency {
+
+    template<typename T>
+    MpmcQueue<T>::MpmcQueue(std::size_t capacity)
+        : mask_(0) {
+        std::size_t size{ 2 };
+        while (size < capacity)
+            size <<= 1;
+        mask_ = size - 1;
+        slots_.reset(new Slot[size]);
+        for (std::size_t i{ 0 }; i < size; ++i)
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    template<typename T>
+    void MpmcQueue<T>::reset() {
+        for (std::size_t i{ 0 }; i <= mask_; ++i) {
+            slots_[i].value.reset();
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        enqueuePosition_.store(0, std::memory_order_relaxed);
+        dequeuePosition_.store(0, std::memory_order_release);
+    }
+
+    template<typename T>
+    std::optional<T> MpmcQueue<T>::pop() {
+        std::optional<T> item;
+        while (!dequeue(item))
+            notEmpty_.wait([this]() { return !isEmpty(); });
+        return item;
+    }
+
+    template<typename T>
+    PopResult MpmcQueue<T>::tryPop(T &item) {
+        return popUntil(item, std::chrono::steady_clock::time_point{});
+    }
+
+    template<typename T>
+    template<typename Rep, typename Period>
+    PopResult MpmcQueue<T>::popFor(T &item, const std::chrono::duration<Rep, Period> &timeout) {
+        return popUntil(item, std::chrono::steady_clock::now() + timeout);
+    }
+
+    template<typename T>
+    template<typename Clock, typename Duration>
+    PopResult MpmcQueue<T>::popUntil(T &item,
+        const std::chrono::time_point<Clock, Duration> &deadline) {
+        std::optional<T> val;
+        while (!dequeue(val)) {
+            if (Clock::now() >= deadline
+                || !notEmpty_.waitUntil(deadline, [this]() { return !isEmpty(); })) {
+                // a message may have arrived at the last moment
+                if (!dequeue(val)) return PopResult::Timeout;
+                break;
+            }
+        }
+        if (!val) return PopResult::Closed;
+        item = std::move(val.value());
+        return PopResult::Ok;
+    }
+
+    template<typename T>
+    void MpmcQueue<T>::push(const T &item) {
+        pushBlocking(std::optional<T>{ item });
+    }
+
+    template<typename T>
+    void MpmcQueue<T>::push(T &&item) {
+        pushBlocking(std::optional<T>{ std::move(item) });
+    }
+
+    template<typename T>
+    bool MpmcQueue<T>::tryPush(const T &item) {
+        if (!enqueue(item)) return false;
+        notEmpty_.notifyAll();
+        return true;
+    }
+
+    template<typename T>
+    bool MpmcQueue<T>::tryPush(T &&item) {
+        if (!enqueue(std::move(item))) return false;
+        notEmpty_.notifyAll();
+        return true;
+    }
+
+    template<typename T>
+    void MpmcQueue<T>::close() {
+        pushBlocking(std::optional<T>{});
+    }
+
+    template<typename T>
+    template<typename U>
+    void MpmcQueue<T>::pushBlocking(U &&item) {
+        while (!enqueue(std::move(item)))
+            notFull_.wait([this]() { return !isFull(); });
+        notEmpty_.notifyAll();
+    }
+
+    template<typename T>
+    template<typename U>
+    bool MpmcQueue<T>::enqueue(U &&item) {
+        std::size_t position{ enqueuePosition_.load(std::memory_order_relaxed) };
+        Slot *slot;
+        while (true) {
+            slot = &slots_[position & mask_];
+            const std::size_t sequence{ slot->sequence.load(std::memory_order_acquire) };
+            const auto difference{ static_cast<std::intptr_t>(sequence)
+                                   - static_cast<std::intptr_t>(position) };
+            if (difference == 0) {
+                if (enqueuePosition_.compare_exchange_weak(
+                        position, position + 1, std::memory_order_relaxed))
+                    break;
+            } else if (difference < 0) {
+                // the slot still holds the message pushed one lap ago
+                return false;
+            } else {
+                position = enqueuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+        // `item` is moved only once the slot is ours
+        slot->value = std::forward<U>(item);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename T>
+    bool MpmcQueue<T>::dequeue(std::optional<T> &item) {
+        std::size_t position{ dequeuePosition_.load(std::memory_order_relaxed) };
+        Slot *slot;
+        while (true) {
+            slot = &slots_[position & mask_];
+            const std::size_t sequence{ slot->sequence.load(std::memory_order_acquire) };
+            const auto difference{ static_cast<std::intptr_t>(sequence)
+                                   - static_cast<std::intptr_t>(position + 1) };
+            if (difference == 0) {
+                if (dequeuePosition_.compare_exchange_weak(
+                        position, position + 1, std::memory_order_relaxed))
+                    break;
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = dequeuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(slot->value);
+        slot->value.reset();
+        // the slot can be written again on the next lap
+        slot->sequence.store(position + mask_ + 1, std::memory_order_release);
+        notFull_.notifyAll();
+        return true;
+    }
+
+    template<typename T>
+    bool MpmcQueue<T>::isFull() const {
+        const std::size_t position{ enqueuePosition_.load(std::memory_order_acquire) };
+        return slots_[position & mask_].sequence.load(std::memory_order_acquire) < position;
+    }
+
+    template<typename T>
+    bool MpmcQueue<T>::isEmpty() const {
+        const std::size_t position{ dequeuePosition_.load(std::memory_order_acquire) };
+        return slots_[position & mask_].sequence.load(std::memory_order_acquire) < position + 1;
+    }
+
+    template<typename T>
+    std::size_t MpmcQueue<T>::size() const {
+        const std::size_t dequeued{ dequeuePosition_.load(std::memory_order_acquire) };
+        const std::size_t enqueued{ enqueuePosition_.load(std::memory_order_acquire) };
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+}// namespace Concurrency
+}// namespace rtb
@@ -0,0 +1,101 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_MpmcQueue_h
+#define rtb_MpmcQueue_h
+
+#include "rtb/concurrency/CacheLine.h"
+#include "rtb/concurrency/EventCount.h"
+#include "rtb/concurrency/PopResult.h"
+#include "rtb/concurrency/SimpleQueue.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+namespace rtb {
+namespace Concurrency {
+    //   MpmcQueue - a bounded, lock-free alternative to `SimpleQueue` for many producers and
+    //               many consumers (Vyukov style ring of sequenced slots):
+    //               - each message is read by one of the consumers, as in `SimpleQueue`
+    //               - `push` and `pop` claim a slot with a single compare-and-swap, so the
+    //                 producers and the consumers do not contend on a lock
+    //               - `push` waits while the queue is full, `pop` waits while it is empty. The
+    //                 threads only park when they have to wait
+    //               - `close` pushes one end of stream, read by one consumer, so call it once
+    //                 for each consumer
+    template<typename T>
+    class MpmcQueue {
+      public:
+        typedef T type;
+
+        // `capacity` is rounded up to the next power of two
+        explicit MpmcQueue(std::size_t capacity = 1024);
+        MpmcQueue(const MpmcQueue &) = delete;
+        MpmcQueue &operator=(const MpmcQueue &) = delete;
+        // returns no value when an end of stream has been read
+        std::optional<T> pop();
+        // Non-blocking and timed pops. They return `PopResult::Ok` when a message has been
+        // stored in `item`
+        PopResult tryPop(T &item);
+        template<typename Rep, typename Period>
+        PopResult popFor(T &item, const std::chrono::duration<Rep, Period> &timeout);
+        template<typename Clock, typename Duration>
+        PopResult popUntil(T &item, const std::chrono::time_point<Clock, Duration> &deadline);
+        void push(const T &item);
+        void push(T &&item);
+        // Pushes `item` unless the queue is full. Returns false, and leaves `item` untouched,
+        // in that case
+        bool tryPush(const T &item);
+        bool tryPush(T &&item);
+        void close();
+        // approximate number of queued messages, end of streams included
+        std::size_t size() const;
+        std::size_t capacity() const { return mask_ + 1; }
+        // Empties the queue, end of streams included, as it was when constructed. No other
+        // thread may use the queue meanwhile
+        void reset();
+
+      private:
+        struct alignas(CacheLineSize) Slot {
+            // `position` when the slot can be written, `position + 1` when it can be read
+            std::atomic<std::size_t> sequence;
+            std::optional<T> value;
+        };
+        template<typename U>
+        bool enqueue(U &&item);
+        bool dequeue(std::optional<T> &item);
+        template<typename U>
+        void pushBlocking(U &&item);
+        bool isFull() const;
+        bool isEmpty() const;
+
+        std::size_t mask_;
+        std::unique_ptr<Slot[]> slots_;
+        alignas(CacheLineSize) std::atomic<std::size_t> enqueuePosition_{ 0 };
+        alignas(CacheLineSize) std::atomic<std::size_t> dequeuePosition_{ 0 };
+        EventCount notEmpty_;
+        EventCount notFull_;
+    };
+
+    // work queue of the `ExecutionPool` workers
+    template<typename T>
+    using IndexedDataMpmcQueue = MpmcQueue<IndexedData<T>>;
+}// namespace Concurrency
+}// namespace rtb
+
+#include "MpmcQueue.cpp"
+#endif
@@ -0,0 +1,33 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_PopResult_h
+#define rtb_PopResult_h
+
+namespace rtb {
+namespace Concurrency {
+    // Outcome of the non-blocking and timed pops
+    enum class PopResult {
+        // a message has been read
+        Ok,
+        // no message arrived before the deadline
+        Timeout,
+        // the queue has been closed
+        Closed
+    };
+}// namespace Concurrency
+}// namespace rtb
+
+#endif
@@ -14,117 +14,690 @@
  * -------------------------------------------------------------------------- */
 #include <iostream>
 #include <algorithm>
+#include <iterator>
+#include <stdexcept>
 
 namespace rtb {
 namespace Concurrency {
 
-    template<typename T>
-    std::optional<T> Queue<T>::pop() {
-        std::unique_lock<std::mutex> mlock(mutex_);
-        while (subscribersMissingRead_[std::this_thread::get_id()] == 0) {
-            cond_.wait(mlock);
-        }
-        auto val{ *subscribersNextRead_[std::this_thread::get_id()] };
-        // advance iterator (maybe goes to .end())
-        subscribersNextRead_[std::this_thread::get_id()]++;
-        subscribersMissingRead_[std::this_thread::get_id()]--;
+    template<typename T, typename WaitStrategy>
+    Queue<T, WaitStrategy>::Queue(size_t capacity, OverflowPolicy policy)
+        : queue_(capacity + 1)
+        , capacity_(capacity)
+        , policy_(policy) {}
+
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::reserve(size_t messages) {
+        auto mlock{ lock() };
+        queue_.reserve(messages);
+    }
+
+    template<typename T, typename WaitStrategy>
+    Queue<T, WaitStrategy>::Subscription::Subscription(Subscription &&other) noexcept
+        : queue_(other.queue_)
+        , subscriber_(other.subscriber_) {
+        other.queue_ = nullptr;
+    }
 
-        if (!someoneSlowerThanMe()) { queue_.pop_front(); }
+    template<typename T, typename WaitStrategy>
+    typename Queue<T, WaitStrategy>::Subscription &Queue<T, WaitStrategy>::Subscription::operator=(
+        Subscription &&other) noexcept {
+        if (this == &other) return *this;
+        // the subscriber held so far would never read again, and hold back the queue
+        if (queue_) unsubscribe();
+        queue_ = other.queue_;
+        subscriber_ = other.subscriber_;
+        other.queue_ = nullptr;
+        return *this;
+    }
 
+    template<typename T, typename WaitStrategy>
+    std::optional<T> Queue<T, WaitStrategy>::pop() {
+        auto mlock{ lock() };
+        return pop(*threadSubscriber(), mlock);
+    }
+
+    template<typename T, typename WaitStrategy>
+    std::optional<T> Queue<T, WaitStrategy>::pop(Subscription &subscription) {
+        auto mlock{ lock() };
+        return pop(*subscription.subscriber_, mlock);
+    }
+
+    template<typename T, typename WaitStrategy>
+    std::optional<T> Queue<T, WaitStrategy>::pop(Subscriber &me,
+        std::unique_lock<std::mutex> &mlock) {
+        waitForMessage(me, mlock);
+        auto val{ read(me) };
         mlock.unlock();
         return val;
     }
 
+    template<typename T, typename WaitStrategy>
+    PopResult Queue<T, WaitStrategy>::tryPop(T &item) {
+        auto mlock{ lock() };
+        return popUntil(*threadSubscriber(), item, std::chrono::steady_clock::time_point{}, mlock);
+    }
+
+    template<typename T, typename WaitStrategy>
+    PopResult Queue<T, WaitStrategy>::tryPop(Subscription &subscription, T &item) {
+        auto mlock{ lock() };
+        return popUntil(
+            *subscription.subscriber_, item, std::chrono::steady_clock::time_point{}, mlock);
+    }
+
+    template<typename T, typename WaitStrategy>
+    PopResult Queue<T, WaitStrategy>::tryPop(Subscription &subscription, std::optional<T> &item) {
+        auto mlock{ lock() };
+        return popUntil(
+            *subscription.subscriber_, item, std::chrono::steady_clock::time_point{}, mlock);
+    }
+
+    template<typename T, typename WaitStrategy>
+    template<typename Rep, typename Period>
+    PopResult Queue<T, WaitStrategy>::popFor(T &item,
+        const std::chrono::duration<Rep, Period> &timeout) {
+        return popUntil(item, std::chrono::steady_clock::now() + timeout);
+    }
+
+    template<typename T, typename WaitStrategy>
+    template<typename Rep, typename Period>
+    PopResult Queue<T, WaitStrategy>::popFor(Subscription &subscription,
+        T &item,
+        const std::chrono::duration<Rep, Period> &timeout) {
+        return popUntil(subscription, item, std::chrono::steady_clock::now() + timeout);
+    }
+
+    template<typename T, typename WaitStrategy>
+    template<typename Clock, typename Duration>
+    PopResult Queue<T, WaitStrategy>::popUntil(T &item,
+        const std::chrono::time_point<Clock, Duration> &deadline) {
+        auto mlock{ lock() };
+        return popUntil(*threadSubscriber(), item, deadline, mlock);
+    }
+
+    template<typename T, typename WaitStrategy>
+    template<typename Clock, typename Duration>
+    PopResult Queue<T, WaitStrategy>::popUntil(Subscription &subscription,
+        T &item,
+        const std::chrono::time_point<Clock, Duration> &deadline) {
+        auto mlock{ lock() };
+        return popUntil(*subscription.subscriber_, item, deadline, mlock);
+    }
+
+    template<typename T, typename WaitStrategy>
+    template<typename Item, typename Clock, typename Duration>
+    PopResult Queue<T, WaitStrategy>::popUntil(Subscriber &me,
+        Item &item,
+        const std::chrono::time_point<Clock, Duration> &deadline,
+        std::unique_lock<std::mutex> &mlock) {
+        if (me.nextRead == tailSequence()) {
+            if (Clock::now() >= deadline) return PopResult::Timeout;
+            Stopwatch stopwatch;
+            while (me.nextRead == tailSequence() && Clock::now() < deadline) {
+                addSleeper(me);
+                me.wakeup.waitUntil(mlock, deadline, [&me]() { return !me.sleeping; });
+            }
+            recordPopBlocked(me, stopwatch.elapsed());
+            if (me.nextRead == tailSequence()) return PopResult::Timeout;
+        }
+        auto val{ read(me) };
+        mlock.unlock();
+        if (!val) return PopResult::Closed;
+        item = std::move(val.value());
+        return PopResult::Ok;
+    }
+
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::waitForMessage(Subscriber &me,
+        std::unique_lock<std::mutex> &mlock) {
+        if (me.nextRead != tailSequence()) return;
+        Stopwatch stopwatch;
+        while (me.nextRead == tailSequence()) {
+            addSleeper(me);
+            me.wakeup.wait(mlock, [&me]() { return !me.sleeping; });
+        }
+        recordPopBlocked(me, stopwatch.elapsed());
+    }
+
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::addSleeper(Subscriber &me) {
+        if (!me.sleeping) {
+            sleepers_.push_back(&me);
+            me.sleeping = true;
+        }
+    }
+
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::wakeSleepers() {
+        // notifying with the lock held, as a subscriber that is not sleeping anymore is free to
+        // unsubscribe as soon as the lock is released
+        for (auto *it : sleepers_) {
+            it->sleeping = false;
+            it->wakeup.notifyAll();
+        }
+        sleepers_.clear();
+        // only the listeners with something to read: nothing may have been pushed, e.g., when a
+        // message has been dropped
+        const Sequence tail{ tailSequence() };
+        listeners_.erase(std::remove_if(listeners_.begin(),
+                             listeners_.end(),
+                             [tail](const auto &it) {
+                                 return it.first->nextRead != tail && !it.second->notify();
+                             }),
+            listeners_.end());
+    }
+
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::attach(const Subscription &subscription, Listener &listener) {
+        auto mlock{ lock() };
+        const Subscriber &me{ *subscription.subscriber_ };
+        if (me.nextRead != tailSequence() && !listener.notify()) return;
+        listeners_.emplace_back(&me, &listener);
+    }
+
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::detach(const Subscription &subscription, Listener &listener) {
+        auto mlock{ lock() };
+        const std::pair<const Subscriber *, Listener *> attached{ &*subscription.subscriber_,
+            &listener };
+        listeners_.erase(std::remove(listeners_.begin(), listeners_.end(), attached),
+            listeners_.end());
+    }
+
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::attachProducer(Listener &listener) {
+        auto mlock{ lock() };
+        if (!isFull() && !listener.notify()) return;
+        producerListeners_.push_back(&listener);
+    }
+
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::detachProducer(Listener &listener) {
+        auto mlock{ lock() };
+        producerListeners_.erase(
+            std::remove(producerListeners_.begin(), producerListeners_.end(), &listener),
+            producerListeners_.end());
+    }
+
+    template<typename T, typename WaitStrategy>
+    std::optional<T> Queue<T, WaitStrategy>::read(Subscriber &me) {
+        Entry &entry{ queue_[me.nextRead - headSequence_] };
+        auto val{ release(entry) };
+        me.nextRead++;
+        if (entry.pendingReaders == 0) trim();
+        if (val) recordPops(me, 1);
+        return val;
+    }
+
+    template<typename T, typename WaitStrategy>
+    std::optional<T> Queue<T, WaitStrategy>::release(Entry &entry) {
+        if (entry.pendingReaders == 1) {
+            entry.pendingReaders = 0;
+            return std::move(entry.value);
+        }
+        if constexpr (std::is_copy_constructible<T>::value) {
+            entry.pendingReaders--;
+            return entry.value;
+        } else {
+            throw std::logic_error("Queue: a move-only message can only have one reader");
+        }
+    }
+
+    template<typename T, typename WaitStrategy>
+    template<typename OutputIt>
+    size_t Queue<T, WaitStrategy>::popBatch(OutputIt out, size_t maxItems) {
+        auto mlock{ lock() };
+        return popBatch(*threadSubscriber(), out, maxItems, mlock);
+    }
+
+    template<typename T, typename WaitStrategy>
+    template<typename OutputIt>
+    size_t Queue<T, WaitStrategy>::popBatch(Subscription &subscription,
+        OutputIt out,
+        size_t maxItems) {
+        auto mlock{ lock() };
+        return popBatch(*subscription.subscriber_, out, maxItems, mlock);
+    }
+
+    template<typename T, typename WaitStrategy>
+    template<typename OutputIt>
+    size_t Queue<T, WaitStrategy>::popBatch(Subscriber &me,
+        OutputIt out,
+        size_t maxItems,
+        std::unique_lock<std::mutex> &mlock) {
+        waitForMessage(me, mlock);
+        size_t count{ 0 };
+        while (count < maxItems && me.nextRead < tailSequence()) {
+            Entry &entry{ queue_[me.nextRead - headSequence_] };
+            // stop before the end of the stream, so that the next call reports it
+            if (!entry.value.has_value() && count > 0) break;
+            auto val{ release(entry) };
+            me.nextRead++;
+            if (!val) break;
+            *out++ = std::move(val.value());
+            ++count;
+        }
+        trim();
+        recordPops(me, count);
+        mlock.unlock();
+        return count;
+    }
+
     // push data only when the queue has subscribers
-    template<typename T>
-    void Queue<T>::push(const T &item) {
-        push(std::optional<T>{ item });
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::push(const T &item) {
+        pushEntry(false, std::in_place, item);
     }
 
-    template<typename T>
-    void Queue<T>::close() {
-        push(std::optional<T>{});
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::push(T &&item) {
+        pushEntry(false, std::in_place, std::move(item));
     }
 
-    template<typename T>
-    void Queue<T>::push(const std::optional<T> &item) {
-        std::unique_lock<std::mutex> mlock(mutex_);
-        if (!subscribersNextRead_.empty()) queue_.push_back(std::optional<T>{ item });
+    template<typename T, typename WaitStrategy>
+    bool Queue<T, WaitStrategy>::tryPush(const T &item) {
+        return tryPushEntry(false, std::in_place, item);
+    }
+
+    template<typename T, typename WaitStrategy>
+    bool Queue<T, WaitStrategy>::tryPush(T &&item) {
+        return tryPushEntry(false, std::in_place, std::move(item));
+    }
 
-        // if you had nothing to read...now you have something
-        for (auto &it : subscribersNextRead_) {
-            if (subscribersMissingRead_[it.first] == 0) it.second = (++queue_.rbegin()).base();
+    template<typename T, typename WaitStrategy>
+    template<typename... Args>
+    bool Queue<T, WaitStrategy>::tryPushEntry(bool isEndOfStream, Args &&... args) {
+        auto mlock{ lock() };
+        if (isFull()) return false;
+        // `makeRoom` does not block anymore, it only applies the dropping policies
+        if (makeRoom(isEndOfStream, mlock) && !subscribers_.empty()) {
+            queue_.emplace_back(subscribers_.size(), std::forward<Args>(args)...);
+            if (!isEndOfStream) recordPush();
         }
+        wakeSleepers();
+        mlock.unlock();
+        return true;
+    }
+
+    template<typename T, typename WaitStrategy>
+    template<typename... Args>
+    void Queue<T, WaitStrategy>::emplace(Args &&... args) {
+        pushEntry(false, std::in_place, std::forward<Args>(args)...);
+    }
+
+    template<typename T, typename WaitStrategy>
+    template<typename InputIt>
+    void Queue<T, WaitStrategy>::pushRange(InputIt first, InputIt last) {
+        auto mlock{ lock() };
+        for (; first != last; ++first) {
+            if (makeRoom(false, mlock) && !subscribers_.empty()) {
+                queue_.emplace_back(subscribers_.size(), std::in_place, *first);
+                recordPush();
+            }
+        }
+        wakeSleepers();
+        mlock.unlock();
+    }
+
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::setProducers(size_t producers) {
+        auto mlock{ lock() };
+        producers_ = producers;
+    }
+
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::close() {
+        auto mlock{ lock() };
+        if (producers_ > 1) {
+            --producers_;
+            return;
+        }
+        mlock.unlock();
+        pushEntry(true);
+    }
+
+    template<typename T, typename WaitStrategy>
+    bool Queue<T, WaitStrategy>::tryClose() {
+        auto mlock{ lock() };
+        if (producers_ > 1) {
+            --producers_;
+            return true;
+        }
+        mlock.unlock();
+        return tryPushEntry(true);
+    }
+
+    template<typename T, typename WaitStrategy>
+    template<typename... Args>
+    void Queue<T, WaitStrategy>::pushEntry(bool isEndOfStream, Args &&... args) {
+        auto mlock{ lock() };
         // new message to be read by everyone
-        for (auto &it : subscribersMissingRead_) {
-            it.second += 1;
+        if (makeRoom(isEndOfStream, mlock) && !subscribers_.empty()) {
+            queue_.emplace_back(subscribers_.size(), std::forward<Args>(args)...);
+            if (!isEndOfStream) recordPush();
         }
+        wakeSleepers();
         mlock.unlock();
+    }
 
-        // maybe no subscribers but do anyway
-        cond_.notify_all();
+    template<typename T, typename WaitStrategy>
+    size_t Queue<T, WaitStrategy>::messagesToRead() const {
+        std::lock_guard<std::mutex> guard{ mutex_ };
+        return tailSequence() - threadSubscriber()->nextRead;
     }
 
-    template<typename T>
-    size_t Queue<T>::messagesToRead() const {
+    template<typename T, typename WaitStrategy>
+    size_t Queue<T, WaitStrategy>::messagesToRead(const Subscription &subscription) const {
         std::lock_guard<std::mutex> guard{ mutex_ };
-        return subscribersMissingRead_.at(std::this_thread::get_id());
+        return tailSequence() - subscription.subscriber_->nextRead;
     }
 
-    template<typename T>
-    void Queue<T>::subscribe() {
-        std::unique_lock<std::mutex> mlock(mutex_);
+    template<typename T, typename WaitStrategy>
+    typename Queue<T, WaitStrategy>::Subscription Queue<T, WaitStrategy>::subscribe() {
+        return subscribe(policy_);
+    }
+
+    template<typename T, typename WaitStrategy>
+    typename Queue<T, WaitStrategy>::Subscription Queue<T, WaitStrategy>::subscribe(
+        OverflowPolicy policy) {
+        auto mlock{ lock() };
+        auto it{ addSubscriber(policy) };
+        it->owner = std::this_thread::get_id();
+        threadSubscribers_[it->owner] = it;
+        mlock.unlock();
+        return Subscription{ this, it };
+    }
+
+    template<typename T, typename WaitStrategy>
+    typename Queue<T, WaitStrategy>::Subscription Queue<T, WaitStrategy>::subscribeUnbound() {
+        return subscribeUnbound(policy_);
+    }
+
+    template<typename T, typename WaitStrategy>
+    typename Queue<T, WaitStrategy>::Subscription Queue<T, WaitStrategy>::subscribeUnbound(
+        OverflowPolicy policy) {
+        auto mlock{ lock() };
+        auto it{ addSubscriber(policy) };
+        mlock.unlock();
+        return Subscription{ this, it };
+    }
+
+    template<typename T, typename WaitStrategy>
+    template<typename Handler>
+    typename Queue<T, WaitStrategy>::CallbackSubscription Queue<T, WaitStrategy>::subscribe(
+        Handler handler,
+        Dispatcher &dispatcher) {
+        auto subscription{ subscribeUnbound() };
+        auto callback{ std::make_unique<Callback>(std::move(subscription),
+            std::function<void(const T &)>(std::move(handler)),
+            dispatcher) };
+        callback->subscription.attach(*callback);
+        return CallbackSubscription{ std::move(callback) };
+    }
+
+    template<typename T, typename WaitStrategy>
+    typename Queue<T, WaitStrategy>::SubscriberIterator Queue<T, WaitStrategy>::addSubscriber(
+        OverflowPolicy policy) {
+        auto it{ subscribers_.emplace(subscribers_.end()) };
+        Subscriber &subscriber{ *it };
+        subscriber.policy = policy;
         if (queue_.empty()) {
-            subscribersNextRead_[std::this_thread::get_id()] = queue_.end();
-            subscribersMissingRead_[std::this_thread::get_id()] = 0;
+            subscriber.nextRead = tailSequence();
         } else {
-            subscribersNextRead_[std::this_thread::get_id()] = (++queue_.rbegin()).base();
-            subscribersMissingRead_[std::this_thread::get_id()] = 1;
+            // start from the last message, which someone else still has to read
+            subscriber.nextRead = tailSequence() - 1;
+            queue_.back().pendingReaders++;
         }
-        mlock.unlock();
+        return it;
     }
 
-    template<typename T>
-    void Queue<T>::unsubscribe() {
-        std::unique_lock<std::mutex> mlock(mutex_);
+    template<typename T, typename WaitStrategy>
+    typename Queue<T, WaitStrategy>::CallbackSubscription &
+        Queue<T, WaitStrategy>::CallbackSubscription::operator=(
+            CallbackSubscription &&other) noexcept {
+        unsubscribe();
+        callback_ = std::move(other.callback_);
+        return *this;
+    }
 
-        int myMsgToRead = 0;
-        if (!someoneSlowerThanMe()) {
-            int myMsgToRead = std::max_element(
-                subscribersMissingRead_.begin(), subscribersMissingRead_.end(), pred)
-                                  ->second;
-            subscribersMissingRead_.erase(std::this_thread::get_id());
-            int otherMaxMsgToRead = 0;
-            if (subscribersMissingRead_.size() != 0)
-                otherMaxMsgToRead = std::max_element(
-                    subscribersMissingRead_.begin(), subscribersMissingRead_.end(), pred)
-                                        ->second;
-            for (int i = 0; i < (otherMaxMsgToRead - myMsgToRead); ++i)
-                queue_.pop_front();
-        } else
-            subscribersMissingRead_.erase(std::this_thread::get_id());
-
-        subscribersNextRead_.erase(std::this_thread::get_id());
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::CallbackSubscription::wait() {
+        callback_->wait();
+    }
 
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::CallbackSubscription::unsubscribe() {
+        if (!callback_) return;
+        callback_->cancel();
+        callback_.reset();
+    }
+
+    template<typename T, typename WaitStrategy>
+    Queue<T, WaitStrategy>::Callback::Callback(Subscription subscription,
+        std::function<void(const T &)> handler,
+        Dispatcher &dispatcher)
+        : subscription(std::move(subscription))
+        , handler(std::move(handler))
+        , dispatcher(dispatcher) {
+        batch.reserve(MaxBatch);
+    }
+
+    template<typename T, typename WaitStrategy>
+    bool Queue<T, WaitStrategy>::Callback::notify() {
+        if (!scheduled.exchange(true)) dispatcher.post(&Callback::dispatch, this);
+        return true;
+    }
+
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::Callback::dispatch(void *callback) {
+        auto &me{ *static_cast<Callback *>(callback) };
+        std::unique_lock<std::mutex> mlock(me.mutex);
+        if (!me.cancelled && !me.closed) {
+            mlock.unlock();
+            // only this dispatch reads from the subscription, so `popBatch` does not wait when
+            // there is something to read. A dispatch with nothing to read does nothing
+            bool endOfStream{ false };
+            if (me.subscription.messagesToRead() > 0)
+                endOfStream = me.subscription.popBatch(std::back_inserter(me.batch), MaxBatch) == 0;
+            for (auto &it : me.batch)
+                me.handler(it);
+            me.batch.clear();
+            mlock.lock();
+            me.closed = endOfStream;
+        }
+        me.scheduled.store(false);
+        // a message pushed before `scheduled` was reset did not post a dispatch
+        if (!me.cancelled && !me.closed && me.subscription.messagesToRead() > 0
+            && !me.scheduled.exchange(true)) {
+            me.dispatcher.post(&Callback::dispatch, &me);
+            return;
+        }
+        me.idle.notify_all();
+    }
+
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::Callback::wait() {
+        std::unique_lock<std::mutex> mlock(mutex);
+        idle.wait(mlock, [this]() { return closed && !scheduled.load(); });
+    }
+
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::Callback::cancel() {
+        std::unique_lock<std::mutex> mlock(mutex);
+        cancelled = true;
+        mlock.unlock();
+        // no dispatch can be posted after this, wait for the one in progress
+        subscription.detach(*this);
+        mlock.lock();
+        idle.wait(mlock, [this]() { return !scheduled.load(); });
+        mlock.unlock();
+        subscription.unsubscribe();
+    }
+
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::unsubscribe() {
+        auto mlock{ lock() };
+        unsubscribe(threadSubscriber());
         mlock.unlock();
     }
 
-    template<typename T>
-    bool Queue<T>::pred(const std::pair<std::thread::id, int> &lhs,
-        const std::pair<std::thread::id, int> &rhs) {
-        return lhs.second < rhs.second;
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::unsubscribe(Subscription &subscription) {
+        auto mlock{ lock() };
+        unsubscribe(subscription.subscriber_);
+        subscription.queue_ = nullptr;
+        mlock.unlock();
     }
 
-    template<typename T>
-    bool Queue<T>::someoneSlowerThanMe() {
-        int maxNoMsgToRead =
-            std::max_element(subscribersMissingRead_.begin(), subscribersMissingRead_.end(), pred)
-                ->second;
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::unsubscribe(SubscriberIterator subscriber) {
+        // the messages this subscriber will never read
+        skip(*subscriber, tailSequence());
+        trim();
+        if (subscriber->sleeping)
+            sleepers_.erase(std::find(sleepers_.begin(), sleepers_.end(), &*subscriber));
+        const Subscriber *me{ &*subscriber };
+        listeners_.erase(std::remove_if(listeners_.begin(),
+                             listeners_.end(),
+                             [me](const auto &it) { return it.first == me; }),
+            listeners_.end());
+        auto owner{ threadSubscribers_.find(subscriber->owner) };
+        if (owner != threadSubscribers_.end() && owner->second == subscriber)
+            threadSubscribers_.erase(owner);
+        subscribers_.erase(subscriber);
+        // the queue might not be full anymore even though nothing has been trimmed, e.g., when
+        // the blocking subscriber leaves and the others at the front can drop messages
+        if (capacity_ > 0) notifyNotFull();
+    }
 
-        if (maxNoMsgToRead > subscribersMissingRead_[std::this_thread::get_id()]) return true;
+    template<typename T, typename WaitStrategy>
+    typename Queue<T, WaitStrategy>::SubscriberIterator
+        Queue<T, WaitStrategy>::threadSubscriber() const {
+        auto it{ threadSubscribers_.find(std::this_thread::get_id()) };
+        if (it == threadSubscribers_.end())
+            throw std::logic_error("Queue: the calling thread is not subscribed");
+        return it->second;
+    }
 
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::trim() {
+        bool trimmed{ false };
+        while (!queue_.empty() && queue_.front().pendingReaders == 0) {
+            queue_.pop_front();
+            ++headSequence_;
+            trimmed = true;
+        }
+        if (trimmed && capacity_ > 0) notifyNotFull();
+    }
+
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::notifyNotFull() {
+        notFull_.notifyAll();
+        producerListeners_.erase(std::remove_if(producerListeners_.begin(),
+                                     producerListeners_.end(),
+                                     [](Listener *it) { return !it->notify(); }),
+            producerListeners_.end());
+    }
+
+    template<typename T, typename WaitStrategy>
+    bool Queue<T, WaitStrategy>::isFull() const {
+        if (capacity_ == 0 || queue_.size() < capacity_) return false;
+        for (auto &it : subscribers_) {
+            if (it.nextRead == headSequence_ && it.policy == OverflowPolicy::Block) return true;
+        }
         return false;
     }
 
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::skip(Subscriber &subscriber, Sequence to) {
+        for (Sequence i{ subscriber.nextRead }; i < to; ++i)
+            queue_[i - headSequence_].pendingReaders--;
+        subscriber.nextRead = to;
+    }
+
+    template<typename T, typename WaitStrategy>
+    bool Queue<T, WaitStrategy>::makeRoom(bool isEndOfStream, std::unique_lock<std::mutex> &mlock) {
+        while (capacity_ > 0 && queue_.size() >= capacity_) {
+            bool block{ false };
+            bool dropNewest{ false };
+            for (auto &it : subscribers_) {
+                if (it.nextRead != headSequence_) continue;
+                block |= (it.policy == OverflowPolicy::Block);
+                dropNewest |= (it.policy == OverflowPolicy::DropNewest);
+            }
+            if (block) {
+                // the messages pushed so far by `pushRange` must be readable while we wait
+                wakeSleepers();
+                // `trim` notifies when the front of the queue moves, `unsubscribe` when the
+                // subscribers at the front change, so that the other policies can apply
+                const Sequence head{ headSequence_ };
+                Stopwatch stopwatch;
+                notFull_.wait(
+                    mlock, [this, head]() { return headSequence_ != head || !isFull(); });
+                const auto blocked{ stopwatch.elapsed() };
+                counters_.record([blocked](QueueMetrics &m) { m.pushBlocked += blocked; });
+                continue;
+            }
+            // the end of the stream is never dropped, otherwise the subscribers would wait forever
+            if (dropNewest) return isEndOfStream;
+            for (auto &it : subscribers_) {
+                if (it.nextRead != headSequence_) continue;
+                if (it.policy == OverflowPolicy::DropOldest)
+                    skip(it, headSequence_ + 1);
+                else
+                    skip(it, tailSequence());
+            }
+            trim();
+        }
+        return true;
+    }
+
+    template<typename T, typename WaitStrategy>
+    QueueMetrics Queue<T, WaitStrategy>::metrics() const {
+        auto mlock{ lock() };
+        QueueMetrics snapshot{ counters_.snapshot() };
+        snapshot.depth = queue_.size();
+        return snapshot;
+    }
+
+    template<typename T, typename WaitStrategy>
+    SubscriberMetrics Queue<T, WaitStrategy>::metrics(const Subscription &subscription) const {
+        auto mlock{ lock() };
+        const Subscriber &me{ *subscription.subscriber_ };
+        SubscriberMetrics snapshot{ me.counters.snapshot() };
+        snapshot.lag = static_cast<size_t>(tailSequence() - me.nextRead);
+        return snapshot;
+    }
+
+    template<typename T, typename WaitStrategy>
+    std::unique_lock<std::mutex> Queue<T, WaitStrategy>::lock() const {
+        Stopwatch stopwatch;
+        std::unique_lock<std::mutex> mlock(mutex_);
+        const auto waited{ stopwatch.elapsed() };
+        counters_.record([waited](QueueMetrics &m) { m.lockWait += waited; });
+        return mlock;
+    }
+
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::recordPush() {
+        counters_.record([this](QueueMetrics &m) {
+            ++m.pushed;
+            m.highWaterMark = std::max(m.highWaterMark, queue_.size());
+        });
+    }
+
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::recordPops(Subscriber &me, size_t count) {
+        counters_.record([count](QueueMetrics &m) { m.popped += count; });
+        me.counters.record([count](SubscriberMetrics &m) { m.popped += count; });
+    }
+
+    template<typename T, typename WaitStrategy>
+    void Queue<T, WaitStrategy>::recordPopBlocked(Subscriber &me,
+        std::chrono::nanoseconds blocked) {
+        counters_.record([blocked](QueueMetrics &m) { m.popBlocked += blocked; });
+        me.counters.record([blocked](SubscriberMetrics &m) { m.popBlocked += blocked; });
+    }
+
 }// namespace Concurrency
 }// namespace rtb
@@ -15,52 +15,348 @@
 #ifndef rtb_Queue_h
 #define rtb_Queue_h
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <list>
 #include <map>
+#include <memory>
+#include <vector>
 #include <thread>
 #include <mutex>
-#include <condition_variable>
 #include <optional>
+#include <type_traits>
+#include <utility>
+#include <chrono>
+#include "rtb/concurrency/Metrics.h"
+#include "rtb/concurrency/PopResult.h"
+#include "rtb/concurrency/RingBuffer.h"
+#include "rtb/concurrency/Dispatcher.h"
+#include "rtb/concurrency/Listener.h"
+#include "rtb/concurrency/WaitStrategy.h"
 
 namespace rtb {
 namespace Concurrency {
-    //   Queue - an implementation of a single producer multiple consumers design pattern
+    // What a bounded `Queue` does when a message is pushed while the queue is full.
+    // The policy applies to the lagging subscribers, i.e., the ones that still have to read the
+    // oldest message.
+    enum class OverflowPolicy {
+        // the producer waits until the lagging subscribers read the oldest message
+        Block,
+        // the new message is discarded
+        DropNewest,
+        // the lagging subscribers lose their oldest message
+        DropOldest,
+        // the lagging subscribers lose all the queued messages and continue from the new one
+        SkipToLatest
+    };
+
+    //   Queue - an implementation of a multiple producers multiple consumers design pattern
     //           with the following constraints:
+    //           - the messages are ordered when they are pushed, so all the subscribers read the
+    //             messages of all the producers in the same order
+    //           - the stream ends when all the producers have called `close`, see `setProducers`
     //           - the consumers can subscribe/unsubscribe to the queue at run time
-    //           - all the messages MUST be consumed by all the subscribed consumers
-    template<typename T>
+    //           - all the messages MUST be consumed by all the subscribed consumers, unless
+    //             the queue is bounded and its `OverflowPolicy` says otherwise
+    //           - messages are copied only for the subscribers that are not the last to read
+    //             them, so move-only messages are supported with a single subscriber
+    //           - the messages are stored in a `RingBuffer`, so once the queue has grown to its
+    //             largest backlog pushing and popping do not allocate memory. A bounded queue
+    //             allocates its storage up front
+    //           - `WaitStrategy` decides how the subscribers wait for new messages and how a
+    //             blocked producer waits for room, see WaitStrategy.h
+    //           - a consumer can also register a handler, called for each message on the
+    //             threads of a shared `Dispatcher` instead of its own thread
+    template<typename T, typename WaitStrategy = BlockingWait>
     class Queue {
+      private:
+        struct Subscriber;
+        struct Callback;
+        typedef typename std::list<Subscriber>::iterator SubscriberIterator;
+
       public:
         typedef T type;
+
+        // Handle to a subscription, returned by `subscribe`.
+        // Reading through the handle does not depend on the calling thread, so a thread can
+        // own several subscriptions, or pass its subscription to another thread. The handle can
+        // be moved but not copied, and must not outlive the queue. Moving onto a handle that is
+        // still subscribed unsubscribes it first. Do not unsubscribe while
+        // another thread is popping from the same subscription.
+        class Subscription {
+          public:
+            typedef T type;
+
+            Subscription() = default;
+            Subscription(const Subscription &) = delete;
+            Subscription &operator=(const Subscription &) = delete;
+            Subscription(Subscription &&other) noexcept;
+            Subscription &operator=(Subscription &&other) noexcept;
+            // returns no value when the queue has been closed
+            std::optional<T> pop() { return queue_->pop(*this); }
+            PopResult tryPop(T &item) { return queue_->tryPop(*this, item); }
+            PopResult tryPop(std::optional<T> &item) { return queue_->tryPop(*this, item); }
+            template<typename Rep, typename Period>
+            PopResult popFor(T &item, const std::chrono::duration<Rep, Period> &timeout) {
+                return queue_->popFor(*this, item, timeout);
+            }
+            template<typename Clock, typename Duration>
+            PopResult popUntil(T &item, const std::chrono::time_point<Clock, Duration> &deadline) {
+                return queue_->popUntil(*this, item, deadline);
+            }
+            template<typename OutputIt>
+            size_t popBatch(OutputIt out, size_t maxItems) {
+                return queue_->popBatch(*this, out, maxItems);
+            }
+            size_t messagesToRead() const { return queue_->messagesToRead(*this); }
+            SubscriberMetrics metrics() const { return queue_->metrics(*this); }
+            // notifies `listener` when this subscription has a message to read, see Listener.h
+            void attach(Listener &listener) { queue_->attach(*this, listener); }
+            void detach(Listener &listener) {
+                if (queue_) queue_->detach(*this, listener);
+            }
+            void unsubscribe() { queue_->unsubscribe(*this); }
+            bool isSubscribed() const { return queue_ != nullptr; }
+
+          private:
+            friend class Queue;
+            Subscription(Queue *queue, SubscriberIterator subscriber)
+                : queue_(queue)
+                , subscriber_(subscriber) {}
+            Queue *queue_{ nullptr };
+            SubscriberIterator subscriber_;
+        };
+
+        // Handle to a callback subscription, returned by `subscribe(handler, dispatcher)`.
+        // The handler is called for one message at a time, in order, so it does not need to be
+        // thread safe. Destroying the handle, or calling `unsubscribe`, stops the calls to the
+        // handler. The handle must not outlive the queue and the dispatcher.
+        class CallbackSubscription {
+          public:
+            CallbackSubscription() = default;
+            CallbackSubscription(CallbackSubscription &&) noexcept = default;
+            CallbackSubscription &operator=(CallbackSubscription &&other) noexcept;
+            ~CallbackSubscription() { unsubscribe(); }
+            // waits until the queue has been closed and all its messages have been handled
+            void wait();
+            // waits for the call to the handler in progress, if any
+            void unsubscribe();
+            bool isSubscribed() const { return callback_ != nullptr; }
+
+          private:
+            friend class Queue;
+            explicit CallbackSubscription(std::unique_ptr<Callback> callback)
+                : callback_(std::move(callback)) {}
+            std::unique_ptr<Callback> callback_;
+        };
+
         Queue() = default;
+        // Bounded queue, keeping at most `capacity` messages. `policy` is used for all the
+        // subscriptions that do not choose their own
+        explicit Queue(size_t capacity, OverflowPolicy policy = OverflowPolicy::Block);
         Queue(const Queue &) = delete;
         Queue &operator=(const Queue &) = delete;
-        void subscribe();
+        // Allocates room for `messages` queued messages, to avoid allocating at run time
+        void reserve(size_t messages);
+        // The subscription is also bound to the calling thread, so that it can be used through
+        // `pop()`, `messagesToRead()` and `unsubscribe()` without passing the handle around.
+        // A thread subscribing again is bound to its latest subscription.
+        Subscription subscribe();
+        // When several lagging subscribers have different policies, `Block` wins over
+        // `DropNewest`, which wins over the two policies that only affect the subscriber itself
+        Subscription subscribe(OverflowPolicy policy);
+        // As `subscribe`, but the calling thread is not bound to the subscription, which is
+        // used through the handle only. Libraries subscribing on behalf of their caller use it,
+        // so that they do not replace a subscription the calling thread already has
+        Subscription subscribeUnbound();
+        Subscription subscribeUnbound(OverflowPolicy policy);
+        // Calls `handler(const T &)` for each message on the threads of `dispatcher`. The
+        // handler must not block nor throw, as it shares the threads with the other handlers.
+        // The calling thread is not bound to the subscription
+        template<typename Handler>
+        CallbackSubscription subscribe(Handler handler, Dispatcher &dispatcher);
         void unsubscribe();
+        void unsubscribe(Subscription &subscription);
         // returns no value when the queue has been closed
         std::optional<T> pop();
+        std::optional<T> pop(Subscription &subscription);
+        // Non-blocking and timed pops, for consumers that cannot wait indefinitely. They return
+        // `PopResult::Ok` when a message has been stored in `item`
+        PopResult tryPop(T &item);
+        PopResult tryPop(Subscription &subscription, T &item);
+        // As `tryPop`, for messages that can not be default constructed
+        PopResult tryPop(Subscription &subscription, std::optional<T> &item);
+        template<typename Rep, typename Period>
+        PopResult popFor(T &item, const std::chrono::duration<Rep, Period> &timeout);
+        template<typename Rep, typename Period>
+        PopResult popFor(Subscription &subscription,
+            T &item,
+            const std::chrono::duration<Rep, Period> &timeout);
+        template<typename Clock, typename Duration>
+        PopResult popUntil(T &item, const std::chrono::time_point<Clock, Duration> &deadline);
+        template<typename Clock, typename Duration>
+        PopResult popUntil(Subscription &subscription,
+            T &item,
+            const std::chrono::time_point<Clock, Duration> &deadline);
+        // Waits for at least one message, then copies up to `maxItems` messages to `out` under a
+        // single lock. Returns the number of messages copied, 0 when the queue has been closed
+        template<typename OutputIt>
+        size_t popBatch(OutputIt out, size_t maxItems);
+        template<typename OutputIt>
+        size_t popBatch(Subscription &subscription, OutputIt out, size_t maxItems);
         void push(const T &item);
+        void push(T &&item);
+        // Pushes `item` unless the producer would have to wait for room, see
+        // `OverflowPolicy::Block`. Returns false, and leaves `item` untouched, in that case
+        bool tryPush(const T &item);
+        bool tryPush(T &&item);
+        // notifies `listener` when `tryPush` would succeed, see Listener.h
+        void attachProducer(Listener &listener);
+        void detachProducer(Listener &listener);
+        // Constructs the message in place from `args`
+        template<typename... Args>
+        void emplace(Args &&... args);
+        // Pushes all the items in [first, last) under a single lock and wakes the subscribers
+        // once
+        template<typename InputIt>
+        void pushRange(InputIt first, InputIt last);
         size_t messagesToRead() const;
+        size_t messagesToRead(const Subscription &subscription) const;
+        // Snapshots of the counters of the queue and of a subscription, see Metrics.h
+        QueueMetrics metrics() const;
+        SubscriberMetrics metrics(const Subscription &subscription) const;
+        // Number of producers that will call `close`, 1 by default. Call it before the
+        // producers start
+        void setProducers(size_t producers);
         // Call `close` when the producer has finished producing data and it is terminating.
+        // The end of the stream is pushed when the last producer closes
         void close();
+        // As `close`, but returns false instead of waiting when the end of the stream does not
+        // fit in the queue, see `tryPush`
+        bool tryClose();
 
       private:
- 
-        // decided to go with a list so we can trust the iterator. With other containers you can
-        // have reallocation that invalidates iterator
-        std::list<std::optional<T>> queue_;
-        typedef typename std::list<std::optional<T>>::iterator QueueIterator;
-        // could be a single map with a structure. But keep in this way cause it helps in function
-        // unsubscribe
-        std::map<std::thread::id, QueueIterator> subscribersNextRead_;
-        std::map<std::thread::id, int> subscribersMissingRead_;
+        typedef unsigned long long Sequence;
+        struct Entry {
+            template<typename... Args>
+            Entry(size_t readers, Args &&... args)
+                : value(std::forward<Args>(args)...)
+                , pendingReaders(readers) {}
+            std::optional<T> value;
+            // subscribers that still have to read this message. Subscribers read the messages
+            // in order, so the counters never decrease from the front to the back of the queue
+            // and the messages already read by everyone are always at the front
+            size_t pendingReaders;
+        };
+        RingBuffer<Entry> queue_;
+        // sequence number of the message at the front of `queue_`
+        Sequence headSequence_{ 0 };
+        struct Subscriber {
+            // sequence number of the next message to read
+            Sequence nextRead;
+            // thread that created the subscription
+            std::thread::id owner;
+            OverflowPolicy policy;
+            // each subscriber waits on its own strategy object, so that a push wakes only the
+            // subscribers that were waiting for a message
+            WaitStrategy wakeup;
+            // true while the subscriber is in `sleepers_`
+            bool sleeping{ false };
+            Counters<SubscriberMetrics> counters;
+        };
+        // Subscriber driven by a `Dispatcher`. A single dispatch is scheduled at a time, so the
+        // messages are handled in order
+        struct Callback : Listener {
+            Callback(Subscription subscription,
+                std::function<void(const T &)> handler,
+                Dispatcher &dispatcher);
+            // called by the queue when a message is pushed
+            bool notify() override;
+            // handles up to `MaxBatch` messages on the dispatcher, then lets the other work run
+            static void dispatch(void *callback);
+            void wait();
+            void cancel();
+            static constexpr size_t MaxBatch{ 64 };
+            Subscription subscription;
+            std::function<void(const T &)> handler;
+            Dispatcher &dispatcher;
+            std::vector<T> batch;
+            // true while a dispatch is posted or running
+            std::atomic<bool> scheduled{ false };
+            std::mutex mutex;
+            std::condition_variable idle;
+            bool cancelled{ false };
+            bool closed{ false };
+        };
+        // a list, so that the iterators held by the subscriptions stay valid
+        std::list<Subscriber> subscribers_;
+        std::map<std::thread::id, SubscriberIterator> threadSubscribers_;
+        // 0 for an unbounded queue
+        size_t capacity_{ 0 };
+        OverflowPolicy policy_{ OverflowPolicy::Block };
+        // producers that have not closed yet
+        size_t producers_{ 1 };
         mutable std::mutex mutex_;
-        std::condition_variable cond_;
-        // utility function used to find the maximum on a map
-        void push(const std::optional<T> &item);
-        static bool pred(const std::pair<std::thread::id, int> &lhs,
-            const std::pair<std::thread::id, int> &rhs);
-        bool someoneSlowerThanMe();
+        mutable Counters<QueueMetrics> counters_;
+        // subscribers that have read everything and are waiting for the next message
+        std::vector<Subscriber *> sleepers_;
+        // a blocked producer waits here for the queue to shrink
+        WaitStrategy notFull_;
+        // listeners waiting for a message to a subscriber, notified at each push
+        std::vector<std::pair<const Subscriber *, Listener *>> listeners_;
+        // listeners waiting for room, notified when the front of the queue moves
+        std::vector<Listener *> producerListeners_;
+        // `args` construct the `std::optional` holding the message, no arguments for the end
+        // of the stream
+        template<typename... Args>
+        void pushEntry(bool isEndOfStream, Args &&... args);
+        std::optional<T> pop(Subscriber &me, std::unique_lock<std::mutex> &mlock);
+        // `Item` is `T` or `std::optional<T>`
+        template<typename Item, typename Clock, typename Duration>
+        PopResult popUntil(Subscriber &me,
+            Item &item,
+            const std::chrono::time_point<Clock, Duration> &deadline,
+            std::unique_lock<std::mutex> &mlock);
+        void waitForMessage(Subscriber &me, std::unique_lock<std::mutex> &mlock);
+        void addSleeper(Subscriber &me);
+        // wakes the subscribers waiting for a message and notifies their listeners
+        void wakeSleepers();
+        void attach(const Subscription &subscription, Listener &listener);
+        void detach(const Subscription &subscription, Listener &listener);
+        template<typename... Args>
+        bool tryPushEntry(bool isEndOfStream, Args &&... args);
+        // true when a new message would have to wait for a lagging subscriber
+        bool isFull() const;
+        // adds a subscriber that is not bound to any thread
+        SubscriberIterator addSubscriber(OverflowPolicy policy);
+        // reads the next message of `me`, which must be available
+        std::optional<T> read(Subscriber &me);
+        // hands the message to one of its readers. The last reader gets the message moved, the
+        // others get a copy, so a move-only message can only have one reader
+        std::optional<T> release(Entry &entry);
+        template<typename OutputIt>
+        size_t popBatch(Subscriber &me,
+            OutputIt out,
+            size_t maxItems,
+            std::unique_lock<std::mutex> &mlock);
+        SubscriberIterator threadSubscriber() const;
+        void unsubscribe(SubscriberIterator subscriber);
+        Sequence tailSequence() const { return headSequence_ + queue_.size(); }
+        // removes from the front the messages read by everyone
+        void trim();
+        // wakes the producers waiting for room, and notifies their listeners
+        void notifyNotFull();
+        // moves `subscriber` forward to `to`, as if it had read the messages in between
+        void skip(Subscriber &subscriber, Sequence to);
+        // takes `mutex_`, measuring the time spent waiting for it
+        std::unique_lock<std::mutex> lock() const;
+        void recordPush();
+        void recordPops(Subscriber &me, size_t count);
+        void recordPopBlocked(Subscriber &me, std::chrono::nanoseconds blocked);
+        // applies the overflow policies until a new message fits in the queue. Returns false
+        // when the new message has to be dropped
+        bool makeRoom(bool isEndOfStream, std::unique_lock<std::mutex> &mlock);
     };
 }// namespace Concurrency
 }// namespace rtb
@@ -0,0 +1,157 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace rtb {
+namespace Concurrency {
+
+    namespace RecordingFormat {
+        constexpr char Magic[8] = { 'r', 't', 'b', 'R', 'E', 'C', '1', '\0' };
+        constexpr std::size_t Alignment = 8;
+
+        inline std::size_t padded(std::size_t size) {
+            return (size + Alignment - 1) / Alignment * Alignment;
+        }
+    }// namespace RecordingFormat
+
+    template<typename T, typename Serializer>
+    Recorder<T, Serializer>::Recorder(Queue<T> &queue,
+        const std::string &path,
+        std::size_t initialSize)
+        : subscription_(queue.subscribeUnbound())
+        , file_(MappedFile::create(path, std::max(initialSize, sizeof(RecordingHeader))))
+        , used_(sizeof(RecordingHeader)) {
+        RecordingHeader header{};
+        std::memcpy(header.magic, RecordingFormat::Magic, sizeof(header.magic));
+        header.elementSize = sizeof(T);
+        header.bytes = used_;
+        std::memcpy(file_.data(), &header, sizeof(header));
+    }
+
+    template<typename T, typename Serializer>
+    Recorder<T, Serializer>::~Recorder() {
+        if (subscription_.isSubscribed()) subscription_.unsubscribe();
+    }
+
+    template<typename T, typename Serializer>
+    void Recorder<T, Serializer>::operator()() {
+        std::chrono::steady_clock::time_point start;
+        bool first{ true };
+        while (auto val{ subscription_.pop() }) {
+            const auto now{ std::chrono::steady_clock::now() };
+            if (first) start = now;
+            first = false;
+            append(val.value(),
+                static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count()));
+        }
+        subscription_.unsubscribe();
+        file_.resize(used_);
+    }
+
+    template<typename T, typename Serializer>
+    std::uint64_t Recorder<T, Serializer>::frames() const {
+        RecordingHeader header;
+        std::memcpy(&header, file_.data(), sizeof(header));
+        return header.frames;
+    }
+
+    template<typename T, typename Serializer>
+    void Recorder<T, Serializer>::append(const T &item, std::uint64_t timestamp) {
+        const std::size_t size{ Serializer::size(item) };
+        const std::size_t needed{ used_ + sizeof(RecordedFrameHeader)
+                                  + RecordingFormat::padded(size) };
+        if (needed > file_.size()) file_.resize(std::max(needed, 2 * file_.size()));
+
+        RecordedFrameHeader frame{ timestamp, size };
+        std::memcpy(file_.data() + used_, &frame, sizeof(frame));
+        Serializer::write(item, file_.data() + used_ + sizeof(frame));
+        used_ = needed;
+
+        // the header is updated after the frame, so that a crash leaves a valid recording
+        RecordingHeader header;
+        std::memcpy(&header, file_.data(), sizeof(header));
+        ++header.frames;
+        header.bytes = used_;
+        std::memcpy(file_.data(), &header, sizeof(header));
+    }
+
+    template<typename T, typename Serializer>
+    Replayer<T, Serializer>::Replayer(const std::string &path)
+        : file_(MappedFile::open(path)) {
+        RecordingHeader header;
+        if (file_.size() < sizeof(header))
+            throw std::runtime_error("Replayer: " + path + " is not a recording");
+        std::memcpy(&header, file_.data(), sizeof(header));
+        if (std::memcmp(header.magic, RecordingFormat::Magic, sizeof(header.magic)) != 0
+            || header.bytes > file_.size())
+            throw std::runtime_error("Replayer: " + path + " is not a recording");
+        if (header.elementSize != sizeof(T))
+            throw std::runtime_error("Replayer: " + path + " records another type");
+        // `replay` reads the frames straight from the mapping, so they must all lie within
+        // the recorded bytes
+        std::uint64_t offset{ sizeof(header) };
+        for (std::uint64_t i{ 0 }; i < header.frames; ++i) {
+            if (header.bytes - offset < sizeof(RecordedFrameHeader))
+                throw std::runtime_error("Replayer: " + path + " is truncated");
+            RecordedFrameHeader frame;
+            std::memcpy(&frame, file_.data() + offset, sizeof(frame));
+            offset += sizeof(frame);
+            if (frame.size > header.bytes - offset)
+                throw std::runtime_error("Replayer: " + path + " is truncated");
+            offset += std::min<std::uint64_t>(
+                RecordingFormat::padded(static_cast<std::size_t>(frame.size)),
+                header.bytes - offset);
+        }
+    }
+
+    template<typename T, typename Serializer>
+    std::uint64_t Replayer<T, Serializer>::frames() const {
+        RecordingHeader header;
+        std::memcpy(&header, file_.data(), sizeof(header));
+        return header.frames;
+    }
+
+    template<typename T, typename Serializer>
+    void Replayer<T, Serializer>::replay(Queue<T> &queue, ReplayTiming timing) const {
+        RecordingHeader header;
+        std::memcpy(&header, file_.data(), sizeof(header));
+        const auto start{ std::chrono::steady_clock::now() };
+        std::size_t offset{ sizeof(header) };
+        // the frames have been checked against the recorded bytes by the constructor
+        try {
+            for (std::uint64_t i{ 0 }; i < header.frames; ++i) {
+                RecordedFrameHeader frame;
+                std::memcpy(&frame, file_.data() + offset, sizeof(frame));
+                const unsigned char *payload{ file_.data() + offset + sizeof(frame) };
+                if (timing == ReplayTiming::Original)
+                    std::this_thread::sleep_until(
+                        start + std::chrono::nanoseconds(frame.timestamp));
+                queue.push(Serializer::read(payload, static_cast<std::size_t>(frame.size)));
+                offset += sizeof(frame)
+                          + RecordingFormat::padded(static_cast<std::size_t>(frame.size));
+            }
+        } catch (...) {
+            // the subscribers would wait forever for the end of the stream
+            queue.close();
+            throw;
+        }
+        queue.close();
+    }
+
+}// namespace Concurrency
+}// namespace rtb
@@ -0,0 +1,129 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_Recording_h
+#define rtb_Recording_h
+
+#include "rtb/concurrency/MappedFile.h"
+#include "rtb/concurrency/Queue.h"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace rtb {
+namespace Concurrency {
+    // Serializer of the messages of a recording. A serializer for `T` provides
+    //   static std::size_t size(const T &item);                      // bytes written by `write`
+    //   static void write(const T &item, unsigned char *out);
+    //   static T read(const unsigned char *in, std::size_t size);
+    // `RawSerializer` copies the bytes of trivially copyable types, so replaying a frame is a
+    // single `memcpy` from the mapping
+    template<typename T>
+    struct RawSerializer {
+        static_assert(std::is_trivially_copyable<T>::value,
+            "RawSerializer: T must be trivially copyable, provide a serializer for it");
+        static std::size_t size(const T &) { return sizeof(T); }
+        static void write(const T &item, unsigned char *out) { std::memcpy(out, &item, sizeof(T)); }
+        static T read(const unsigned char *in, std::size_t size) {
+            if (size != sizeof(T))
+                throw std::runtime_error("RawSerializer: the frame is not a T");
+            T item;
+            std::memcpy(&item, in, sizeof(T));
+            return item;
+        }
+    };
+
+    enum class ReplayTiming {
+        // the frames are pushed one after the other
+        AsFastAsPossible,
+        // the frames are pushed with the same intervals they had when they were recorded
+        Original
+    };
+
+    // Layout of a recording: a `RecordingHeader`, then each frame as a `RecordedFrameHeader`
+    // followed by the serialized message, padded to a multiple of 8 bytes
+    struct RecordingHeader {
+        char magic[8];
+        // `sizeof(T)`, to check that the recording is read with the type it was written with
+        std::uint64_t elementSize;
+        std::uint64_t frames;
+        // end of the last frame
+        std::uint64_t bytes;
+    };
+
+    struct RecordedFrameHeader {
+        // nanoseconds since the first frame, taken when the recorder read the frame, see
+        // `Recorder`
+        std::uint64_t timestamp;
+        std::uint64_t size;
+    };
+
+    //   Recorder - a subscriber of a `Queue` that appends all the messages to a memory-mapped
+    //              file, with the time at which they were read. Run it in its own thread, as
+    //              any other consumer, and it returns when the queue is closed. It subscribes
+    //              when it is constructed, through a handle that is not bound to the
+    //              constructing thread, so the messages pushed before it runs are recorded
+    //              too. The loop unsubscribes at the end of the stream, the destructor when
+    //              the recorder never ran. The file grows by doubling its size, and is
+    //              truncated to the recorded data at the end. The recording stays readable if
+    //              the process crashes.
+    //              The timestamps are dequeue times: a frame is stamped when the recorder
+    //              reads it, so the messages queued while it was behind, or before it ran,
+    //              get close timestamps. Replaying a recording reproduces the pace at which
+    //              the recorder read them, not the one at which they were pushed.
+    template<typename T, typename Serializer = RawSerializer<T>>
+    class Recorder {
+      public:
+        Recorder(Queue<T> &queue,
+            const std::string &path,
+            std::size_t initialSize = std::size_t{ 1 } << 20);
+        Recorder(const Recorder &) = delete;
+        Recorder &operator=(const Recorder &) = delete;
+        ~Recorder();
+        void operator()();
+        std::uint64_t frames() const;
+
+      private:
+        void append(const T &item, std::uint64_t timestamp);
+
+        typename Queue<T>::Subscription subscription_;
+        MappedFile file_;
+        std::size_t used_;
+    };
+
+    //   Replayer - reads a file written by `Recorder` and pushes its messages in a `Queue`,
+    //              straight from the mapping
+    template<typename T, typename Serializer = RawSerializer<T>>
+    class Replayer {
+      public:
+        // throws `std::runtime_error` when `path` is not a recording of `T`, or when its
+        // frames do not fit in the recorded bytes (e.g., a truncated or corrupted file)
+        explicit Replayer(const std::string &path);
+        std::uint64_t frames() const;
+        // Pushes all the frames, then closes `queue`. `queue` is also closed when the serializer
+        // throws on a frame, before the exception is passed on
+        void replay(Queue<T> &queue, ReplayTiming timing = ReplayTiming::AsFastAsPossible) const;
+
+      private:
+        MappedFile file_;
+    };
+}// namespace Concurrency
+}// namespace rtb
+
+#include "Recording.cpp"
+#endif
@@ -0,0 +1,77 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+namespace rtb {
+namespace Concurrency {
+
+    template<typename T>
+    ReorderBuffer<T>::ReorderBuffer(std::size_t capacity)
+        : mask_(0) {
+        std::size_t size{ 2 };
+        while (size < capacity)
+            size <<= 1;
+        mask_ = size - 1;
+        slots_.reset(new Slot[size]);
+        for (std::size_t i{ 0 }; i < size; ++i)
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    template<typename T>
+    void ReorderBuffer<T>::reset() {
+        for (std::size_t i{ 0 }; i <= mask_; ++i) {
+            slots_[i].value.reset();
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        next_.store(0, std::memory_order_release);
+    }
+
+    template<typename T>
+    void ReorderBuffer<T>::push(IndexT idx, const T &item) {
+        store(idx, item);
+    }
+
+    template<typename T>
+    void ReorderBuffer<T>::push(IndexT idx, T &&item) {
+        store(idx, std::move(item));
+    }
+
+    template<typename T>
+    template<typename U>
+    void ReorderBuffer<T>::store(IndexT idx, U &&item) {
+        Slot &slot{ slots_[idx & mask_] };
+        // the slot is still used by the result one lap behind
+        free_.wait([&slot, idx]() { return slot.sequence.load(std::memory_order_acquire) == idx; });
+        slot.value = std::forward<U>(item);
+        slot.sequence.store(idx + 1, std::memory_order_release);
+        ready_.notifyAll();
+    }
+
+    template<typename T>
+    T ReorderBuffer<T>::pop() {
+        const IndexT idx{ next_.load(std::memory_order_relaxed) };
+        Slot &slot{ slots_[idx & mask_] };
+        ready_.wait(
+            [&slot, idx]() { return slot.sequence.load(std::memory_order_acquire) == idx + 1; });
+        T item{ std::move(slot.value.value()) };
+        slot.value.reset();
+        next_.store(idx + 1, std::memory_order_release);
+        // free for the result one lap ahead
+        slot.sequence.store(idx + mask_ + 1, std::memory_order_release);
+        free_.notifyAll();
+        return item;
+    }
+
+}// namespace Concurrency
+}// namespace rtb
@@ -0,0 +1,77 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_ReorderBuffer_h
+#define rtb_ReorderBuffer_h
+
+#include "rtb/concurrency/CacheLine.h"
+#include "rtb/concurrency/EventCount.h"
+#include "rtb/concurrency/SimpleQueue.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+namespace rtb {
+namespace Concurrency {
+    //   ReorderBuffer - puts back in order the results computed out of order by several
+    //                   workers, e.g., by the workers of an `ExecutionPool`:
+    //                   - the result with index `idx` is stored in slot `idx % capacity`, so
+    //                     storing and releasing a result are O(1) whatever the type of the
+    //                     result
+    //                   - any number of workers can `push`, a single consumer can `pop`
+    //                   - a worker waits while its index is `capacity` or more ahead of the next
+    //                     result to release, the consumer waits for the next result only
+    //                   The indices start from 0 and must not have gaps.
+    template<typename T>
+    class ReorderBuffer {
+      public:
+        typedef T type;
+
+        // `capacity` is rounded up to the next power of two
+        explicit ReorderBuffer(std::size_t capacity = 1024);
+        ReorderBuffer(const ReorderBuffer &) = delete;
+        ReorderBuffer &operator=(const ReorderBuffer &) = delete;
+        void push(IndexT idx, const T &item);
+        void push(IndexT idx, T &&item);
+        // the next result in index order, waits until it has been pushed
+        T pop();
+        // index of the next result to release
+        IndexT next() const { return next_.load(std::memory_order_acquire); }
+        std::size_t capacity() const { return mask_ + 1; }
+        // Drops the stored results and restarts the indices from 0, as when constructed. No
+        // other thread may use the buffer meanwhile
+        void reset();
+
+      private:
+        struct alignas(CacheLineSize) Slot {
+            // `idx` when the slot is free for result `idx`, `idx + 1` when it holds it
+            std::atomic<IndexT> sequence;
+            std::optional<T> value;
+        };
+        template<typename U>
+        void store(IndexT idx, U &&item);
+
+        std::size_t mask_;
+        std::unique_ptr<Slot[]> slots_;
+        alignas(CacheLineSize) std::atomic<IndexT> next_{ 0 };
+        EventCount ready_;
+        EventCount free_;
+    };
+}// namespace Concurrency
+}// namespace rtb
+
+#include "ReorderBuffer.cpp"
+#endif
@@ -0,0 +1,97 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+namespace rtb {
+namespace Concurrency {
+
+    template<typename T>
+    RingBuffer<T>::RingBuffer(RingBuffer &&other) noexcept
+        : slots_(std::move(other.slots_))
+        , capacity_(other.capacity_)
+        , head_(other.head_)
+        , size_(other.size_) {
+        other.capacity_ = 0;
+        other.head_ = 0;
+        other.size_ = 0;
+    }
+
+    template<typename T>
+    RingBuffer<T> &RingBuffer<T>::operator=(RingBuffer &&other) noexcept {
+        if (this == &other) return *this;
+        clear();
+        slots_ = std::move(other.slots_);
+        capacity_ = other.capacity_;
+        head_ = other.head_;
+        size_ = other.size_;
+        other.capacity_ = 0;
+        other.head_ = 0;
+        other.size_ = 0;
+        return *this;
+    }
+
+    template<typename T>
+    void RingBuffer<T>::reserve(size_type capacity) {
+        if (capacity <= capacity_) return;
+        size_type newCapacity{ MinCapacity };
+        while (newCapacity < capacity)
+            newCapacity <<= 1;
+        relocate(std::make_unique<Slot[]>(newCapacity), newCapacity);
+    }
+
+    template<typename T>
+    template<typename... Args>
+    typename RingBuffer<T>::reference RingBuffer<T>::emplace_back(Args &&...args) {
+        if (size_ < capacity_) {
+            T *item{ new (element(head_ + size_)) T(std::forward<Args>(args)...) };
+            ++size_;
+            return *item;
+        }
+        // `args` might refer to an element of the buffer, so the new element is built before
+        // the others are moved away
+        const size_type newCapacity{ capacity_ > 0 ? capacity_ * 2 : MinCapacity };
+        auto slots{ std::make_unique<Slot[]>(newCapacity) };
+        new (slots[size_].bytes) T(std::forward<Args>(args)...);
+        relocate(std::move(slots), newCapacity);
+        ++size_;
+        return back();
+    }
+
+    template<typename T>
+    void RingBuffer<T>::pop_front() {
+        element(head_)->~T();
+        ++head_;
+        if (--size_ == 0) head_ = 0;
+    }
+
+    template<typename T>
+    void RingBuffer<T>::clear() {
+        while (size_ > 0)
+            pop_front();
+    }
+
+    template<typename T>
+    void RingBuffer<T>::relocate(std::unique_ptr<Slot[]> slots, size_type capacity) {
+        for (size_type i{ 0 }; i < size_; ++i) {
+            T *item{ element(head_ + i) };
+            new (slots[i].bytes) T(std::move(*item));
+            item->~T();
+        }
+        slots_ = std::move(slots);
+        capacity_ = capacity;
+        head_ = 0;
+    }
+
+}// namespace Concurrency
+}// namespace rtb
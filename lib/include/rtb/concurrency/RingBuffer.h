@@ -0,0 +1,89 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_RingBuffer_h
+#define rtb_RingBuffer_h
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace rtb {
+namespace Concurrency {
+    //   RingBuffer - a FIFO container that can be used as storage by `std::queue` and by the
+    //                queues in this library. Elements live in a single circular array that
+    //                doubles its size when it is full and never shrinks, so once the buffer has
+    //                grown to the largest backlog (or has been `reserve`d up front) pushing and
+    //                popping do not allocate memory.
+    template<typename T>
+    class RingBuffer {
+      public:
+        typedef T value_type;
+        typedef T &reference;
+        typedef const T &const_reference;
+        typedef std::size_t size_type;
+
+        RingBuffer() = default;
+        explicit RingBuffer(size_type capacity) { reserve(capacity); }
+        RingBuffer(const RingBuffer &) = delete;
+        RingBuffer &operator=(const RingBuffer &) = delete;
+        RingBuffer(RingBuffer &&other) noexcept;
+        RingBuffer &operator=(RingBuffer &&other) noexcept;
+        ~RingBuffer() { clear(); }
+
+        // `i`-th element from the front
+        reference operator[](size_type i) { return *element(head_ + i); }
+        const_reference operator[](size_type i) const { return *element(head_ + i); }
+        reference front() { return *element(head_); }
+        const_reference front() const { return *element(head_); }
+        reference back() { return *element(head_ + size_ - 1); }
+        const_reference back() const { return *element(head_ + size_ - 1); }
+        bool empty() const { return size_ == 0; }
+        size_type size() const { return size_; }
+        size_type capacity() const { return capacity_; }
+        // makes room for at least `capacity` elements, rounded up to the next power of two
+        void reserve(size_type capacity);
+
+        void push_back(const T &item) { emplace_back(item); }
+        void push_back(T &&item) { emplace_back(std::move(item)); }
+        template<typename... Args>
+        reference emplace_back(Args &&...args);
+        void pop_front();
+        void clear();
+
+      private:
+        static constexpr size_type MinCapacity = 16;
+        struct Slot {
+            alignas(T) unsigned char bytes[sizeof(T)];
+        };
+        T *element(size_type position) const {
+            return std::launder(reinterpret_cast<T *>(slots_[position & (capacity_ - 1)].bytes));
+        }
+        // moves the elements to a new array of `capacity` slots, where `back` (if any) has
+        // already been constructed after them
+        void relocate(std::unique_ptr<Slot[]> slots, size_type capacity);
+
+        std::unique_ptr<Slot[]> slots_;
+        size_type capacity_{ 0 };
+        // position of the front element, it grows with the pops and is wrapped by `element`
+        size_type head_{ 0 };
+        size_type size_{ 0 };
+    };
+}// namespace Concurrency
+}// namespace rtb
+
+#include "RingBuffer.cpp"
+#endif
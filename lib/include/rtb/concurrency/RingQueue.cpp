@@ -0,0 +1,186 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include <algorithm>
+#include <stdexcept>
+
+namespace rtb {
+namespace Concurrency {
+
+    template<typename T>
+    RingQueue<T>::RingQueue(std::size_t capacity, std::size_t maxSubscribers)
+        : mask_(0)
+        , maxSubscribers_(maxSubscribers)
+        , cursors_(new Cursor[maxSubscribers]) {
+        std::size_t size{ 2 };
+        while (size < capacity)
+            size <<= 1;
+        mask_ = size - 1;
+        buffer_.resize(size);
+        for (std::size_t i{ 0 }; i < maxSubscribers_; ++i)
+            cursors_[i].owner.store(std::thread::id{}, std::memory_order_relaxed);
+    }
+
+    template<typename T>
+    RingQueue<T>::Subscription::Subscription(Subscription &&other) noexcept
+        : queue_(other.queue_)
+        , cursor_(other.cursor_) {
+        other.queue_ = nullptr;
+    }
+
+    template<typename T>
+    typename RingQueue<T>::Subscription &RingQueue<T>::Subscription::operator=(
+        Subscription &&other) noexcept {
+        if (this == &other) return *this;
+        // the cursor held so far would never advance again, and hold back the producer
+        if (queue_) unsubscribe();
+        queue_ = other.queue_;
+        cursor_ = other.cursor_;
+        other.queue_ = nullptr;
+        return *this;
+    }
+
+    template<typename T>
+    std::optional<T> RingQueue<T>::pop() {
+        return pop(threadCursor());
+    }
+
+    template<typename T>
+    std::optional<T> RingQueue<T>::pop(Subscription &subscription) {
+        return pop(*subscription.cursor_);
+    }
+
+    template<typename T>
+    std::optional<T> RingQueue<T>::pop(Cursor &cursor) {
+        Sequence next{ cursor.next.load(std::memory_order_relaxed) };
+        consumersEvent_.wait(
+            [&]() { return published_.load(std::memory_order_acquire) > next; });
+        std::optional<T> val{ buffer_[next & mask_] };
+        // from now on the producer can overwrite the slot
+        cursor.next.store(next + 1, std::memory_order_release);
+        producerEvent_.notifyAll();
+        return val;
+    }
+
+    template<typename T>
+    void RingQueue<T>::push(const T &item) {
+        push(std::optional<T>{ item });
+    }
+
+    template<typename T>
+    void RingQueue<T>::close() {
+        push(std::optional<T>{});
+    }
+
+    template<typename T>
+    void RingQueue<T>::push(const std::optional<T> &item) {
+        Sequence seq{ published_.load(std::memory_order_relaxed) };
+        // the cached gating sequence is a lower bound of the slowest cursor, so the ring is
+        // scanned again only when it looks full
+        while (seq >= gatingSequence_ + capacity()) {
+            std::unique_lock<std::mutex> mlock(subscriptionMutex_);
+            gatingSequence_ = slowestCursor(seq);
+            mlock.unlock();
+            if (seq < gatingSequence_ + capacity()) break;
+            producerEvent_.wait([&]() { return seq < slowestCursor(seq) + capacity(); });
+        }
+        buffer_[seq & mask_] = item;
+        published_.store(seq + 1, std::memory_order_release);
+        consumersEvent_.notifyAll();
+    }
+
+    template<typename T>
+    size_t RingQueue<T>::messagesToRead() const {
+        return messagesToRead(threadCursor());
+    }
+
+    template<typename T>
+    size_t RingQueue<T>::messagesToRead(const Subscription &subscription) const {
+        return messagesToRead(*subscription.cursor_);
+    }
+
+    template<typename T>
+    size_t RingQueue<T>::messagesToRead(const Cursor &cursor) const {
+        return static_cast<size_t>(published_.load(std::memory_order_acquire)
+                                   - cursor.next.load(std::memory_order_relaxed));
+    }
+
+    template<typename T>
+    typename RingQueue<T>::Subscription RingQueue<T>::subscribe() {
+        std::unique_lock<std::mutex> mlock(subscriptionMutex_);
+        const auto me{ std::this_thread::get_id() };
+        Cursor *freeCursor{ nullptr };
+        for (std::size_t i{ 0 }; i < maxSubscribers_; ++i) {
+            // the calling thread is bound to the new subscription only
+            if (cursors_[i].owner.load(std::memory_order_relaxed) == me)
+                cursors_[i].owner.store(std::thread::id{}, std::memory_order_relaxed);
+            if (!cursors_[i].active.load(std::memory_order_relaxed) && !freeCursor)
+                freeCursor = &cursors_[i];
+        }
+        if (!freeCursor) throw std::length_error("RingQueue: too many subscribers");
+
+        // as in `Queue`, a new subscriber starts from the last message when someone else still
+        // has to read it, otherwise it waits for the next message
+        Sequence published{ published_.load(std::memory_order_acquire) };
+        Sequence start{ published };
+        if (published > 0 && slowestCursor(published) < published) start = published - 1;
+        freeCursor->next.store(start, std::memory_order_relaxed);
+        freeCursor->owner.store(me, std::memory_order_relaxed);
+        freeCursor->active.store(true, std::memory_order_release);
+        mlock.unlock();
+        return Subscription{ this, freeCursor };
+    }
+
+    template<typename T>
+    void RingQueue<T>::unsubscribe() {
+        unsubscribe(threadCursor());
+    }
+
+    template<typename T>
+    void RingQueue<T>::unsubscribe(Subscription &subscription) {
+        unsubscribe(*subscription.cursor_);
+        subscription.queue_ = nullptr;
+    }
+
+    template<typename T>
+    void RingQueue<T>::unsubscribe(Cursor &cursor) {
+        std::unique_lock<std::mutex> mlock(subscriptionMutex_);
+        cursor.owner.store(std::thread::id{}, std::memory_order_relaxed);
+        cursor.active.store(false, std::memory_order_release);
+        mlock.unlock();
+        // the producer might be waiting for this subscriber
+        producerEvent_.notifyAll();
+    }
+
+    template<typename T>
+    typename RingQueue<T>::Cursor &RingQueue<T>::threadCursor() const {
+        const auto me{ std::this_thread::get_id() };
+        for (std::size_t i{ 0 }; i < maxSubscribers_; ++i) {
+            if (cursors_[i].owner.load(std::memory_order_acquire) == me) return cursors_[i];
+        }
+        throw std::logic_error("RingQueue: the calling thread is not subscribed");
+    }
+
+    template<typename T>
+    typename RingQueue<T>::Sequence RingQueue<T>::slowestCursor(Sequence published) const {
+        Sequence slowest{ published };
+        for (std::size_t i{ 0 }; i < maxSubscribers_; ++i) {
+            if (cursors_[i].active.load(std::memory_order_acquire))
+                slowest = std::min(slowest, cursors_[i].next.load(std::memory_order_acquire));
+        }
+        return slowest;
+    }
+
+}// namespace Concurrency
+}// namespace rtb
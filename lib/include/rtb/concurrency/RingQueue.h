@@ -0,0 +1,125 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_RingQueue_h
+#define rtb_RingQueue_h
+
+#include "rtb/concurrency/CacheLine.h"
+#include "rtb/concurrency/EventCount.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <optional>
+
+namespace rtb {
+namespace Concurrency {
+    //   RingQueue - a drop-in alternative to `Queue` for a single producer and multiple consumers,
+    //               built on a fixed size broadcast ring buffer (Disruptor style):
+    //               - every message is written once in the ring and read in place by all the
+    //                 subscribers, each subscriber owns an atomic cursor on its own cache line
+    //               - `push` and `pop` do not take any lock, `subscribe` and `unsubscribe` do
+    //               - all the messages MUST be consumed by all the subscribed consumers, so when
+    //                 the ring is full the producer waits for the slowest subscriber
+    //               - at most `maxSubscribers` consumers can be subscribed at the same time
+    template<typename T>
+    class RingQueue {
+      private:
+        struct Cursor;
+
+      public:
+        typedef T type;
+
+        // Handle to a subscription, returned by `subscribe`. Same rules as
+        // `Queue<T>::Subscription`: it is not tied to the calling thread, it can be moved but not
+        // copied, and must not outlive the queue. Moving onto a handle that is still subscribed
+        // unsubscribes it first.
+        class Subscription {
+          public:
+            Subscription() = default;
+            Subscription(const Subscription &) = delete;
+            Subscription &operator=(const Subscription &) = delete;
+            Subscription(Subscription &&other) noexcept;
+            Subscription &operator=(Subscription &&other) noexcept;
+            // returns no value when the queue has been closed
+            std::optional<T> pop() { return queue_->pop(*this); }
+            size_t messagesToRead() const { return queue_->messagesToRead(*this); }
+            void unsubscribe() { queue_->unsubscribe(*this); }
+            bool isSubscribed() const { return queue_ != nullptr; }
+
+          private:
+            friend class RingQueue;
+            Subscription(RingQueue *queue, Cursor *cursor)
+                : queue_(queue)
+                , cursor_(cursor) {}
+            RingQueue *queue_{ nullptr };
+            Cursor *cursor_{ nullptr };
+        };
+
+        // `capacity` is rounded up to the next power of two
+        explicit RingQueue(std::size_t capacity = 1024, std::size_t maxSubscribers = 64);
+        RingQueue(const RingQueue &) = delete;
+        RingQueue &operator=(const RingQueue &) = delete;
+        // As in `Queue`, the subscription is also bound to the calling thread
+        Subscription subscribe();
+        void unsubscribe();
+        void unsubscribe(Subscription &subscription);
+        // returns no value when the queue has been closed
+        std::optional<T> pop();
+        std::optional<T> pop(Subscription &subscription);
+        void push(const T &item);
+        size_t messagesToRead() const;
+        size_t messagesToRead(const Subscription &subscription) const;
+        // Call `close` when the producer has finished producing data and it is terminating.
+        void close();
+        std::size_t capacity() const { return mask_ + 1; }
+
+      private:
+        using Sequence = std::uint64_t;
+        struct alignas(CacheLineSize) Cursor {
+            std::atomic<bool> active{ false };
+            // thread bound to the cursor for the calls without a subscription handle
+            std::atomic<std::thread::id> owner;
+            // sequence number of the next message to read
+            std::atomic<Sequence> next{ 0 };
+        };
+
+        void push(const std::optional<T> &item);
+        std::optional<T> pop(Cursor &cursor);
+        size_t messagesToRead(const Cursor &cursor) const;
+        void unsubscribe(Cursor &cursor);
+        Cursor &threadCursor() const;
+        // minimum among the subscribers' cursors, or `published` when nobody is subscribed
+        Sequence slowestCursor(Sequence published) const;
+
+        std::size_t mask_;
+        std::vector<std::optional<T>> buffer_;
+        std::size_t maxSubscribers_;
+        std::unique_ptr<Cursor[]> cursors_;
+        // number of messages written in the ring
+        alignas(CacheLineSize) std::atomic<Sequence> published_{ 0 };
+        // producer only: lower bound of the slowest cursor, refreshed when the ring looks full
+        alignas(CacheLineSize) Sequence gatingSequence_{ 0 };
+        mutable std::mutex subscriptionMutex_;
+        EventCount consumersEvent_;
+        EventCount producerEvent_;
+    };
+}// namespace Concurrency
+}// namespace rtb
+
+#include "RingQueue.cpp"
+#endif
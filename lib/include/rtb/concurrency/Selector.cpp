@@ -0,0 +1,51 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+namespace rtb {
+namespace Concurrency {
+
+    template<typename Source>
+    size_t Selector::add(Source &source) {
+        source.attach(*this);
+        sources_.push_back({ &source,
+            [](void *s) { return static_cast<Source *>(s)->messagesToRead() > 0; },
+            [](void *s, Selector &selector) { static_cast<Source *>(s)->detach(selector); } });
+        return sources_.size() - 1;
+    }
+
+    template<typename Rep, typename Period>
+    std::optional<size_t> Selector::waitFor(const std::chrono::duration<Rep, Period> &timeout) {
+        return waitUntil(std::chrono::steady_clock::now() + timeout);
+    }
+
+    template<typename Clock, typename Duration>
+    std::optional<size_t> Selector::waitUntil(
+        const std::chrono::time_point<Clock, Duration> &deadline) {
+        while (true) {
+            // read before scanning, so that a push after the scan is not missed
+            const auto seen{ notifications() };
+            if (auto ready{ findReady() }) return ready;
+            std::unique_lock<std::mutex> mlock(mutex_);
+            waiting_ = true;
+            const bool notified{ cond_.wait_until(
+                mlock, deadline, [this, seen]() { return notifications_ != seen; }) };
+            waiting_ = false;
+            mlock.unlock();
+            if (!notified) return findReady();
+        }
+    }
+
+}// namespace Concurrency
+}// namespace rtb
@@ -0,0 +1,83 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_Selector_h
+#define rtb_Selector_h
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "rtb/concurrency/Listener.h"
+
+namespace rtb {
+namespace Concurrency {
+    //   Selector - waits on several queues at once and tells which one has a message to read, so
+    //              that a single thread can service many inputs (e.g., a marker `Queue` and a
+    //              force plate `SimpleQueue`) whatever their element types:
+    //              - `add` a `Queue<T>::Subscription` or a `SimpleQueue<T>`, it returns the
+    //                index of the source in the selector
+    //              - `wait` returns the index of a source with a message to read, then pop from
+    //                that source. The end of the stream counts as a message
+    //              - the sources are scanned round-robin, starting after the last source
+    //                returned, so a busy source does not starve the others
+    //              - a selector is used by a single thread, and its sources must outlive it. Do
+    //                not wait after unsubscribing one of the sources
+    //              With several consumers on the same `SimpleQueue` the message can be taken by
+    //              another consumer between `wait` and `pop`, use `tryPop` in that case.
+    class Selector : public Listener {
+      public:
+        Selector() = default;
+        Selector(const Selector &) = delete;
+        Selector &operator=(const Selector &) = delete;
+        ~Selector();
+        template<typename Source>
+        size_t add(Source &source);
+        size_t size() const { return sources_.size(); }
+        // index of a source with a message to read
+        size_t wait();
+        // as `wait`, but returns no value when no source is ready within `timeout`
+        template<typename Rep, typename Period>
+        std::optional<size_t> waitFor(const std::chrono::duration<Rep, Period> &timeout);
+        template<typename Clock, typename Duration>
+        std::optional<size_t> waitUntil(const std::chrono::time_point<Clock, Duration> &deadline);
+        // called by the sources, with their lock held, when a message is pushed
+        bool notify() override;
+
+      private:
+        // type erased source, so that sources of different types share the same selector
+        struct Entry {
+            void *source;
+            bool (*ready)(void *source);
+            void (*detach)(void *source, Selector &selector);
+        };
+        // the first source with a message to read, in round-robin order
+        std::optional<size_t> findReady();
+        unsigned long long notifications();
+        std::vector<Entry> sources_;
+        size_t next_{ 0 };
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        // incremented by each `notify`, a change while scanning the sources means new messages
+        unsigned long long notifications_{ 0 };
+        bool waiting_{ false };
+    };
+}// namespace Concurrency
+}// namespace rtb
+
+#include "Selector.cpp"
+#endif
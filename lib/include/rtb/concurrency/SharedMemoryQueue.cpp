@@ -0,0 +1,222 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include <algorithm>
+#include <cerrno>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <signal.h>
+#include <unistd.h>
+
+namespace rtb {
+namespace Concurrency {
+
+    template<typename T>
+    SharedMemoryQueue<T>::Subscription::Subscription(Subscription &&other) noexcept
+        : queue_(other.queue_)
+        , cursor_(other.cursor_) {
+        other.queue_ = nullptr;
+    }
+
+    template<typename T>
+    typename SharedMemoryQueue<T>::Subscription &SharedMemoryQueue<T>::Subscription::operator=(
+        Subscription &&other) noexcept {
+        if (this == &other) return *this;
+        // the cursor held so far lives in the segment and its process is alive, so nobody
+        // would ever reclaim it: release it before it holds back all the producers
+        if (queue_) unsubscribe();
+        queue_ = other.queue_;
+        cursor_ = other.cursor_;
+        other.queue_ = nullptr;
+        return *this;
+    }
+
+    template<typename T>
+    std::size_t SharedMemoryQueue<T>::cursorsOffset() {
+        return (sizeof(Header) + alignof(Cursor) - 1) / alignof(Cursor) * alignof(Cursor);
+    }
+
+    template<typename T>
+    std::size_t SharedMemoryQueue<T>::slotsOffset(std::size_t maxSubscribers) {
+        constexpr std::size_t alignment{ std::max(alignof(T), CacheLineSize) };
+        const std::size_t cursorsEnd{ cursorsOffset() + maxSubscribers * sizeof(Cursor) };
+        return (cursorsEnd + alignment - 1) / alignment * alignment;
+    }
+
+    template<typename T>
+    std::size_t SharedMemoryQueue<T>::segmentSize(std::size_t capacity,
+        std::size_t maxSubscribers) {
+        return slotsOffset(maxSubscribers) + capacity * sizeof(T);
+    }
+
+    template<typename T>
+    SharedMemoryQueue<T>::SharedMemoryQueue(SharedMemorySegment segment)
+        : segment_(std::move(segment))
+        , header_(static_cast<Header *>(segment_.data()))
+        , cursors_(nullptr)
+        , slots_(nullptr) {
+        auto *base{ static_cast<unsigned char *>(segment_.data()) };
+        const auto maxSubscribers{ static_cast<std::size_t>(header_->maxSubscribers) };
+        cursors_ = reinterpret_cast<Cursor *>(base + cursorsOffset());
+        slots_ = reinterpret_cast<T *>(base + slotsOffset(maxSubscribers));
+    }
+
+    template<typename T>
+    SharedMemoryQueue<T> SharedMemoryQueue<T>::create(const std::string &name,
+        std::size_t capacity,
+        std::size_t maxSubscribers) {
+        if (capacity == 0 || maxSubscribers == 0)
+            throw std::invalid_argument("SharedMemoryQueue: empty queue");
+        auto segment{ SharedMemorySegment::create(name, segmentSize(capacity, maxSubscribers)) };
+        // the segment is filled with zeros: inactive cursors, nothing published, not closed
+        auto *header{ new (segment.data()) Header{} };
+        header->elementSize = sizeof(T);
+        header->capacity = capacity;
+        header->maxSubscribers = maxSubscribers;
+        initProcessShared(header->mutex);
+        initProcessShared(header->notEmpty);
+        initProcessShared(header->notFull);
+        header->published = 0;
+        header->closed = false;
+        header->ready.store(Magic, std::memory_order_release);
+        return SharedMemoryQueue(std::move(segment));
+    }
+
+    template<typename T>
+    SharedMemoryQueue<T> SharedMemoryQueue<T>::open(const std::string &name) {
+        auto segment{ SharedMemorySegment::open(name) };
+        const auto *header{ static_cast<const Header *>(segment.data()) };
+        if (segment.size() < sizeof(Header)
+            || header->ready.load(std::memory_order_acquire) != Magic)
+            throw std::runtime_error("SharedMemoryQueue: " + name + " is not a ready queue");
+        if (header->elementSize != sizeof(T)
+            || segment.size() < segmentSize(header->capacity, header->maxSubscribers))
+            throw std::runtime_error("SharedMemoryQueue: " + name + " holds another type");
+        return SharedMemoryQueue(std::move(segment));
+    }
+
+    template<typename T>
+    typename SharedMemoryQueue<T>::Subscription SharedMemoryQueue<T>::subscribe() {
+        ProcessLock lock(header_->mutex);
+        for (std::size_t i{ 0 }; i < header_->maxSubscribers; ++i) {
+            if (cursors_[i].active) continue;
+            cursors_[i].active = true;
+            cursors_[i].owner = getpid();
+            cursors_[i].next = header_->published;
+            return Subscription{ this, i };
+        }
+        throw std::length_error("SharedMemoryQueue: too many subscribers");
+    }
+
+    template<typename T>
+    void SharedMemoryQueue<T>::unsubscribe(Subscription &subscription) {
+        {
+            ProcessLock lock(header_->mutex);
+            cursors_[subscription.cursor_].active = false;
+            pthread_cond_broadcast(&header_->notFull);
+        }
+        subscription.queue_ = nullptr;
+    }
+
+    template<typename T>
+    std::optional<T> SharedMemoryQueue<T>::pop(Subscription &subscription) {
+        Cursor &me{ cursors_[subscription.cursor_] };
+        ProcessLock lock(header_->mutex);
+        while (me.next == header_->published && !header_->closed)
+            lock.wait(header_->notEmpty);
+        if (me.next == header_->published) return std::nullopt;
+        std::optional<T> val{ slots_[me.next % header_->capacity] };
+        ++me.next;
+        pthread_cond_broadcast(&header_->notFull);
+        return val;
+    }
+
+    template<typename T>
+    template<typename Rep, typename Period>
+    PopResult SharedMemoryQueue<T>::popFor(Subscription &subscription,
+        T &item,
+        const std::chrono::duration<Rep, Period> &timeout) {
+        return popUntil(subscription, item, std::chrono::steady_clock::now() + timeout);
+    }
+
+    template<typename T>
+    template<typename Clock, typename Duration>
+    PopResult SharedMemoryQueue<T>::popUntil(Subscription &subscription,
+        T &item,
+        const std::chrono::time_point<Clock, Duration> &deadline) {
+        Cursor &me{ cursors_[subscription.cursor_] };
+        ProcessLock lock(header_->mutex);
+        while (me.next == header_->published && !header_->closed) {
+            if (Clock::now() >= deadline || !lock.waitUntil(header_->notEmpty, deadline))
+                return PopResult::Timeout;
+        }
+        if (me.next == header_->published) return PopResult::Closed;
+        item = slots_[me.next % header_->capacity];
+        ++me.next;
+        pthread_cond_broadcast(&header_->notFull);
+        return PopResult::Ok;
+    }
+
+    template<typename T>
+    void SharedMemoryQueue<T>::push(const T &item) {
+        ProcessLock lock(header_->mutex);
+        while (header_->published - slowestCursor() >= header_->capacity) {
+            // a consumer that died would block the producers forever, so it is looked for
+            // every now and then while waiting
+            if (releaseDeadSubscribers()) continue;
+            const auto recheck{ std::chrono::steady_clock::now() + std::chrono::milliseconds(100) };
+            lock.waitUntil(header_->notFull, recheck);
+        }
+        slots_[header_->published % header_->capacity] = item;
+        ++header_->published;
+        pthread_cond_broadcast(&header_->notEmpty);
+    }
+
+    template<typename T>
+    void SharedMemoryQueue<T>::close() {
+        ProcessLock lock(header_->mutex);
+        header_->closed = true;
+        pthread_cond_broadcast(&header_->notEmpty);
+    }
+
+    template<typename T>
+    size_t SharedMemoryQueue<T>::messagesToRead(const Subscription &subscription) const {
+        ProcessLock lock(header_->mutex);
+        return static_cast<size_t>(header_->published - cursors_[subscription.cursor_].next);
+    }
+
+    template<typename T>
+    typename SharedMemoryQueue<T>::Sequence SharedMemoryQueue<T>::slowestCursor() const {
+        Sequence slowest{ header_->published };
+        for (std::size_t i{ 0 }; i < header_->maxSubscribers; ++i) {
+            if (cursors_[i].active) slowest = std::min(slowest, cursors_[i].next);
+        }
+        return slowest;
+    }
+
+    template<typename T>
+    bool SharedMemoryQueue<T>::releaseDeadSubscribers() {
+        bool released{ false };
+        for (std::size_t i{ 0 }; i < header_->maxSubscribers; ++i) {
+            if (cursors_[i].active && kill(cursors_[i].owner, 0) == -1 && errno == ESRCH) {
+                cursors_[i].active = false;
+                released = true;
+            }
+        }
+        return released;
+    }
+
+}// namespace Concurrency
+}// namespace rtb
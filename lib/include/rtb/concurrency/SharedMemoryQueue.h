@@ -0,0 +1,152 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_SharedMemoryQueue_h
+#define rtb_SharedMemoryQueue_h
+
+#include "rtb/concurrency/CacheLine.h"
+#include "rtb/concurrency/PopResult.h"
+#include "rtb/concurrency/SharedMemorySegment.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <sys/types.h>
+
+namespace rtb {
+namespace Concurrency {
+    //   SharedMemoryQueue - a `Queue` that lives in a POSIX shared memory segment, so that
+    //                       producers and consumers can run in different processes.
+    //                       - one process `create`s the queue with a name, the others `open`
+    //                         it by name, then subscribe, pop, push and close as with `Queue`
+    //                       - the messages are copied in a fixed size broadcast ring, so `T`
+    //                         must be trivially copyable and must not hold pointers
+    //                       - all the messages MUST be consumed by all the subscribers: when the
+    //                         ring is full the producers wait for the slowest subscriber. The
+    //                         subscriptions of processes that died are released automatically
+    //                       - a new subscriber reads the messages pushed after it subscribed
+    //                       - the creator owns the name, which is removed when its queue is
+    //                         destroyed. Processes that already opened the queue keep using it
+    template<typename T>
+    class SharedMemoryQueue {
+        static_assert(std::is_trivially_copyable<T>::value,
+            "SharedMemoryQueue: T must be trivially copyable");
+
+      public:
+        typedef T type;
+
+        // Handle to a subscription, returned by `subscribe`. It can be moved but not copied,
+        // and must not outlive the queue object it comes from. Moving onto a handle that is
+        // still subscribed unsubscribes it first.
+        class Subscription {
+          public:
+            Subscription() = default;
+            Subscription(const Subscription &) = delete;
+            Subscription &operator=(const Subscription &) = delete;
+            Subscription(Subscription &&other) noexcept;
+            Subscription &operator=(Subscription &&other) noexcept;
+            // returns no value when the queue has been closed
+            std::optional<T> pop() { return queue_->pop(*this); }
+            template<typename Rep, typename Period>
+            PopResult popFor(T &item, const std::chrono::duration<Rep, Period> &timeout) {
+                return queue_->popFor(*this, item, timeout);
+            }
+            size_t messagesToRead() const { return queue_->messagesToRead(*this); }
+            void unsubscribe() { queue_->unsubscribe(*this); }
+            bool isSubscribed() const { return queue_ != nullptr; }
+
+          private:
+            friend class SharedMemoryQueue;
+            Subscription(SharedMemoryQueue *queue, std::size_t cursor)
+                : queue_(queue)
+                , cursor_(cursor) {}
+            SharedMemoryQueue *queue_{ nullptr };
+            std::size_t cursor_{ 0 };
+        };
+
+        // Throws `std::system_error` when the segment cannot be created, e.g. `name` exists
+        static SharedMemoryQueue create(const std::string &name,
+            std::size_t capacity = 1024,
+            std::size_t maxSubscribers = 16);
+        // Throws `std::system_error` when there is no segment called `name`, and
+        // `std::runtime_error` when the segment is not a queue of `T`
+        static SharedMemoryQueue open(const std::string &name);
+        SharedMemoryQueue(SharedMemoryQueue &&) = default;
+        SharedMemoryQueue &operator=(SharedMemoryQueue &&) = default;
+
+        // throws `std::length_error` when `maxSubscribers` are subscribed already
+        Subscription subscribe();
+        void unsubscribe(Subscription &subscription);
+        // returns no value when the queue has been closed
+        std::optional<T> pop(Subscription &subscription);
+        template<typename Rep, typename Period>
+        PopResult popFor(Subscription &subscription,
+            T &item,
+            const std::chrono::duration<Rep, Period> &timeout);
+        void push(const T &item);
+        size_t messagesToRead(const Subscription &subscription) const;
+        // Call `close` when the producer has finished producing data and it is terminating.
+        void close();
+        std::size_t capacity() const { return static_cast<std::size_t>(header_->capacity); }
+
+      private:
+        using Sequence = std::uint64_t;
+        static constexpr std::uint32_t Magic = 0x72746251;// "rtbQ"
+        struct Header {
+            // set to `Magic` by the creator when the segment is ready
+            std::atomic<std::uint32_t> ready;
+            std::uint32_t elementSize;
+            std::uint64_t capacity;
+            std::uint64_t maxSubscribers;
+            pthread_mutex_t mutex;
+            pthread_cond_t notEmpty;
+            pthread_cond_t notFull;
+            // number of messages pushed
+            Sequence published;
+            bool closed;
+        };
+        struct Cursor {
+            bool active;
+            // process that owns the subscription
+            pid_t owner;
+            // sequence number of the next message to read
+            Sequence next;
+        };
+
+        explicit SharedMemoryQueue(SharedMemorySegment segment);
+        static std::size_t cursorsOffset();
+        static std::size_t slotsOffset(std::size_t maxSubscribers);
+        static std::size_t segmentSize(std::size_t capacity, std::size_t maxSubscribers);
+        template<typename Clock, typename Duration>
+        PopResult popUntil(Subscription &subscription,
+            T &item,
+            const std::chrono::time_point<Clock, Duration> &deadline);
+        // minimum among the active cursors, or `published` when nobody is subscribed
+        Sequence slowestCursor() const;
+        // releases the subscriptions of the processes that do not exist anymore
+        bool releaseDeadSubscribers();
+
+        SharedMemorySegment segment_;
+        Header *header_;
+        Cursor *cursors_;
+        T *slots_;
+    };
+}// namespace Concurrency
+}// namespace rtb
+
+#include "SharedMemoryQueue.cpp"
+#endif
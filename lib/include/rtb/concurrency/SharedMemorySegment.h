@@ -0,0 +1,86 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_SharedMemorySegment_h
+#define rtb_SharedMemorySegment_h
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <pthread.h>
+
+namespace rtb {
+namespace Concurrency {
+    //   SharedMemorySegment - a named POSIX shared memory segment (`shm_open` + `mmap`) mapped
+    //                         in the address space of the process. The segment that creates the
+    //                         name owns it, and removes the name when it is destroyed; the
+    //                         processes that have opened it keep their mapping until they
+    //                         destroy their own segment.
+    //                         Errors of the system calls are thrown as `std::system_error`.
+    class SharedMemorySegment {
+      public:
+        // Creates a new segment of `size` bytes, filled with zeros. Throws if `name` exists
+        static SharedMemorySegment create(const std::string &name, std::size_t size);
+        // Maps an existing segment, with the size chosen by its creator
+        static SharedMemorySegment open(const std::string &name);
+        // Removes `name`, e.g. left behind by a process that crashed. Returns false when there
+        // was no segment with that name
+        static bool remove(const std::string &name);
+
+        SharedMemorySegment(const SharedMemorySegment &) = delete;
+        SharedMemorySegment &operator=(const SharedMemorySegment &) = delete;
+        SharedMemorySegment(SharedMemorySegment &&other) noexcept;
+        SharedMemorySegment &operator=(SharedMemorySegment &&other) noexcept;
+        ~SharedMemorySegment();
+
+        void *data() const { return data_; }
+        std::size_t size() const { return size_; }
+        const std::string &name() const { return name_; }
+        bool isOwner() const { return owner_; }
+
+      private:
+        SharedMemorySegment(std::string name, void *data, std::size_t size, bool owner);
+        void release();
+
+        std::string name_;
+        void *data_{ nullptr };
+        std::size_t size_{ 0 };
+        bool owner_{ false };
+    };
+
+    // Initialise the synchronisation objects stored in a segment, so that they can be shared
+    // by processes. The mutex is robust: when its owner dies the next `ProcessLock` takes it.
+    // The condition variable measures timeouts with `std::chrono::steady_clock`
+    void initProcessShared(pthread_mutex_t &mutex);
+    void initProcessShared(pthread_cond_t &cond);
+
+    //   ProcessLock - holds a process-shared mutex for its lifetime, as `std::unique_lock`
+    class ProcessLock {
+      public:
+        explicit ProcessLock(pthread_mutex_t &mutex);
+        ProcessLock(const ProcessLock &) = delete;
+        ProcessLock &operator=(const ProcessLock &) = delete;
+        ~ProcessLock();
+        void wait(pthread_cond_t &cond);
+        // returns false when `deadline` has passed
+        bool waitUntil(pthread_cond_t &cond, const std::chrono::steady_clock::time_point &deadline);
+
+      private:
+        pthread_mutex_t &mutex_;
+    };
+}// namespace Concurrency
+}// namespace rtb
+
+#endif
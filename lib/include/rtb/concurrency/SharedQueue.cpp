@@ -0,0 +1,35 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+namespace rtb {
+namespace Concurrency {
+
+    template<typename T, typename WaitStrategy>
+    void SharedQueue<T, WaitStrategy>::push(const SharedPayload<T> &item) {
+        Queue<SharedPayload<T>, WaitStrategy>::push(item);
+    }
+
+    template<typename T, typename WaitStrategy>
+    void SharedQueue<T, WaitStrategy>::push(const T &item) {
+        push(std::make_shared<const T>(item));
+    }
+
+    template<typename T, typename WaitStrategy>
+    void SharedQueue<T, WaitStrategy>::push(T &&item) {
+        push(std::make_shared<const T>(std::move(item)));
+    }
+
+}// namespace Concurrency
+}// namespace rtb
@@ -0,0 +1,48 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_SharedQueue_h
+#define rtb_SharedQueue_h
+
+#include "rtb/concurrency/Queue.h"
+#include <memory>
+#include <utility>
+
+namespace rtb {
+namespace Concurrency {
+    // Read-only, reference counted message
+    template<typename T>
+    using SharedPayload = std::shared_ptr<const T>;
+
+    //   SharedQueue - a `Queue` that stores each message only once, whatever the number of
+    //                 subscribers.
+    //                 `pop` returns a `SharedPayload<T>`, so handing a message to a subscriber
+    //                 costs a reference count increment instead of a copy of `T`. The message is
+    //                 released when the last subscriber has read it and has dropped its handle.
+    //                 Use it for large messages (e.g., marker frames) read by many subscribers.
+    template<typename T, typename WaitStrategy = BlockingWait>
+    class SharedQueue : public Queue<SharedPayload<T>, WaitStrategy> {
+      public:
+        void push(const SharedPayload<T> &item);
+        // copies `item` once into the shared payload
+        void push(const T &item);
+        // moves `item` into the shared payload
+        void push(T &&item);
+    };
+}// namespace Concurrency
+}// namespace rtb
+
+#include "SharedQueue.cpp"
+#endif
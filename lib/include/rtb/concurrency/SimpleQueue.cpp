@@ -12,79 +12,279 @@
  * See the License for the specific language governing permissions and        *
  * limitations under the License.                                             *
  * -------------------------------------------------------------------------- */
+#include <algorithm>
 #include <numeric>
 
 namespace rtb {
 namespace Concurrency {
 
-    template<typename T, typename QueueType>
-    std::optional<T> SimpleQueue<T, QueueType>::pop() {
-        std::unique_lock<std::mutex> mlock(mutex_);
-        while (queue_.empty()) {
-            cond_.wait(mlock);
-        }
-        auto val{ queue_.front() };
+    template<typename T, typename QueueType, typename WaitStrategy>
+    std::optional<T> SimpleQueue<T, QueueType, WaitStrategy>::pop() {
+        auto mlock{ lock() };
+        wait(mlock, [this]() { return !queue_.empty(); });
+        auto val{ std::move(queue_.front()) };
         queue_.pop();
+        if (val) recordPops(1);
         mlock.unlock();
         return val;
     }
 
-        template<typename T, typename QueueType>
-    std::optional<T> SimpleQueue<T, QueueType>::front() {
-        std::unique_lock<std::mutex> mlock(mutex_);
-        while (queue_.empty()) {
-            cond_.wait(mlock);
+    template<typename T, typename QueueType, typename WaitStrategy>
+    PopResult SimpleQueue<T, QueueType, WaitStrategy>::tryPop(T &item) {
+        return popUntil(item, std::chrono::steady_clock::time_point{});
+    }
+
+    template<typename T, typename QueueType, typename WaitStrategy>
+    PopResult SimpleQueue<T, QueueType, WaitStrategy>::tryPop(std::optional<T> &item) {
+        return popInto(item, std::chrono::steady_clock::time_point{});
+    }
+
+    template<typename T, typename QueueType, typename WaitStrategy>
+    template<typename Rep, typename Period>
+    PopResult SimpleQueue<T, QueueType, WaitStrategy>::popFor(T &item,
+        const std::chrono::duration<Rep, Period> &timeout) {
+        return popUntil(item, std::chrono::steady_clock::now() + timeout);
+    }
+
+    template<typename T, typename QueueType, typename WaitStrategy>
+    template<typename Clock, typename Duration>
+    PopResult SimpleQueue<T, QueueType, WaitStrategy>::popUntil(T &item,
+        const std::chrono::time_point<Clock, Duration> &deadline) {
+        return popInto(item, deadline);
+    }
+
+    template<typename T, typename QueueType, typename WaitStrategy>
+    template<typename Item, typename Clock, typename Duration>
+    PopResult SimpleQueue<T, QueueType, WaitStrategy>::popInto(Item &item,
+        const std::chrono::time_point<Clock, Duration> &deadline) {
+        auto mlock{ lock() };
+        if (!waitUntil(mlock, deadline, [this]() { return !queue_.empty(); }))
+            return PopResult::Timeout;
+        auto val{ std::move(queue_.front()) };
+        queue_.pop();
+        if (val) recordPops(1);
+        mlock.unlock();
+        if (!val) return PopResult::Closed;
+        item = std::move(val.value());
+        return PopResult::Ok;
+    }
+
+    template<typename T, typename QueueType, typename WaitStrategy>
+    template<typename OutputIt>
+    size_t SimpleQueue<T, QueueType, WaitStrategy>::popBatch(OutputIt out, size_t maxItems) {
+        auto mlock{ lock() };
+        wait(mlock, [this]() { return !queue_.empty(); });
+        size_t count{ 0 };
+        while (count < maxItems && !queue_.empty()) {
+            if (!queue_.front().has_value()) {
+                // a consumer consumes a single end of stream, as in `pop`
+                if (count == 0) queue_.pop();
+                break;
+            }
+            *out++ = std::move(queue_.front().value());
+            queue_.pop();
+            ++count;
         }
+        recordPops(count);
+        mlock.unlock();
+        return count;
+    }
+
+    template<typename T, typename QueueType, typename WaitStrategy>
+    std::optional<T> SimpleQueue<T, QueueType, WaitStrategy>::front() {
+        auto mlock{ lock() };
+        wait(mlock, [this]() { return !queue_.empty(); });
         auto val{ queue_.front() };
         mlock.unlock();
         return val;
     }
 
 
-    template<typename T, typename QueueType>
-    size_t SimpleQueue<T, QueueType>::size() {
-        std::lock_guard<std::mutex> mlock(mutex_);
+    template<typename T, typename QueueType, typename WaitStrategy>
+    size_t SimpleQueue<T, QueueType, WaitStrategy>::size() {
+        auto mlock{ lock() };
+        return queue_.size();
+    }
+
+    template<typename T, typename QueueType, typename WaitStrategy>
+    size_t SimpleQueue<T, QueueType, WaitStrategy>::messagesToRead() const {
+        auto mlock{ lock() };
         return queue_.size();
     }
 
+    template<typename T, typename QueueType, typename WaitStrategy>
+    QueueMetrics SimpleQueue<T, QueueType, WaitStrategy>::metrics() const {
+        auto mlock{ lock() };
+        QueueMetrics snapshot{ counters_.snapshot() };
+        snapshot.depth = queue_.size();
+        return snapshot;
+    }
+
    
-    template<typename T, typename QueueType>
+    template<typename T, typename QueueType, typename WaitStrategy>
+    void SimpleQueue<T, QueueType, WaitStrategy>::reserve(size_t messages) {
+        // the standard queue adaptors expose their container to derived classes only
+        struct Access : QueueType {
+            static auto &container(QueueType &queue) { return queue.*(&Access::c); }
+        };
+        auto mlock{ lock() };
+        Access::container(queue_).reserve(messages);
+    }
+
+    template<typename T, typename QueueType, typename WaitStrategy>
     template<typename U, typename Q>
     typename std::enable_if<std::is_same<Q, PriorityQueue<U>>::value,
         std::optional<T>>::type
-        SimpleQueue<T, QueueType>::popIndex(IndexT idx) {
-        std::unique_lock<std::mutex> mlock(mutex_);
-        auto defaultValue = std::make_tuple<unsigned long long, double>(
-            std::numeric_limits<unsigned long long>::max(), 0.);
-        while (queue_.empty() || std::get<0>(queue_.top().value_or(defaultValue))
-                    != idx) {
-            cond_.wait(mlock);
-        }
+        SimpleQueue<T, QueueType, WaitStrategy>::popIndex(IndexT idx) {
+        auto mlock{ lock() };
+        // the end of stream markers are sorted last, so they are never returned
+        wait(mlock, [this, idx]() {
+            return !queue_.empty() && queue_.top().has_value()
+                   && std::get<0>(queue_.top().value()) == idx;
+        });
         std::optional<T> val{ queue_.top() };
         queue_.pop();
+        if (val) recordPops(1);
         mlock.unlock();
         return val;
     }
 
 
-    template<typename T, typename QueueType>
-    void SimpleQueue<T, QueueType>::push(const T &item) {
-        push(std::optional<T>{ item });
+    template<typename T, typename QueueType, typename WaitStrategy>
+    template<typename Rep, typename Period, typename U, typename Q>
+    typename std::enable_if<std::is_same<Q, PriorityQueue<U>>::value, PopResult>::type
+        SimpleQueue<T, QueueType, WaitStrategy>::popIndexFor(IndexT idx,
+            T &item,
+            const std::chrono::duration<Rep, Period> &timeout) {
+        auto mlock{ lock() };
+        // as in `popIndex`, the end of stream markers are never returned
+        auto isNext([this, idx]() {
+            return !queue_.empty() && queue_.top().has_value()
+                   && std::get<0>(queue_.top().value()) == idx;
+        });
+        if (!waitUntil(mlock, std::chrono::steady_clock::now() + timeout, isNext))
+            return PopResult::Timeout;
+        item = queue_.top().value();
+        queue_.pop();
+        recordPops(1);
+        mlock.unlock();
+        return PopResult::Ok;
     }
 
-    template<typename T, typename QueueType>
-    void SimpleQueue<T, QueueType>::push(const std::optional<T>& item) {
-        std::unique_lock<std::mutex> mlock(mutex_);
-        queue_.push(item);
+    template<typename T, typename QueueType, typename WaitStrategy>
+    void SimpleQueue<T, QueueType, WaitStrategy>::push(const T &item) {
+        pushItem(std::in_place, item);
+    }
+
+    template<typename T, typename QueueType, typename WaitStrategy>
+    void SimpleQueue<T, QueueType, WaitStrategy>::push(T &&item) {
+        pushItem(std::in_place, std::move(item));
+    }
+
+    template<typename T, typename QueueType, typename WaitStrategy>
+    template<typename... Args>
+    void SimpleQueue<T, QueueType, WaitStrategy>::emplace(Args &&...args) {
+        pushItem(std::in_place, std::forward<Args>(args)...);
+    }
+
+    // `args` construct the `std::optional<T>` stored in the queue, no arguments push the
+    // end-of-stream marker
+    template<typename T, typename QueueType, typename WaitStrategy>
+    template<typename... Args>
+    void SimpleQueue<T, QueueType, WaitStrategy>::pushItem(Args &&...args) {
+        auto mlock{ lock() };
+        queue_.emplace(std::forward<Args>(args)...);
+        if (sizeof...(Args) > 0) recordPush();
+        notifyListeners();
         mlock.unlock();
-        cond_.notify_one();
+        cond_.notifyOne();
+    }
+
+    template<typename T, typename QueueType, typename WaitStrategy>
+    template<typename InputIt>
+    void SimpleQueue<T, QueueType, WaitStrategy>::pushRange(InputIt first, InputIt last) {
+        auto mlock{ lock() };
+        for (; first != last; ++first) {
+            queue_.emplace(std::in_place, *first);
+            recordPush();
+        }
+        notifyListeners();
+        mlock.unlock();
+        cond_.notifyAll();
+    }
+
+    template<typename T, typename QueueType, typename WaitStrategy>
+    void SimpleQueue<T, QueueType, WaitStrategy>::close() {
+        pushItem();
     }
 
-    template<typename T, typename QueueType>
-    void SimpleQueue<T, QueueType>::close() {
-        push(std::optional<T>{});
+    template<typename T, typename QueueType, typename WaitStrategy>
+    void SimpleQueue<T, QueueType, WaitStrategy>::attach(Listener &listener) {
+        auto mlock{ lock() };
+        if (!queue_.empty() && !listener.notify()) return;
+        listeners_.push_back(&listener);
     }
 
+    template<typename T, typename QueueType, typename WaitStrategy>
+    void SimpleQueue<T, QueueType, WaitStrategy>::detach(Listener &listener) {
+        auto mlock{ lock() };
+        listeners_.erase(std::remove(listeners_.begin(), listeners_.end(), &listener),
+            listeners_.end());
+    }
+
+    template<typename T, typename QueueType, typename WaitStrategy>
+    void SimpleQueue<T, QueueType, WaitStrategy>::notifyListeners() {
+        listeners_.erase(std::remove_if(listeners_.begin(),
+                             listeners_.end(),
+                             [](Listener *it) { return !it->notify(); }),
+            listeners_.end());
+    }
+
+    template<typename T, typename QueueType, typename WaitStrategy>
+    std::unique_lock<std::mutex> SimpleQueue<T, QueueType, WaitStrategy>::lock() const {
+        Stopwatch stopwatch;
+        std::unique_lock<std::mutex> mlock(mutex_);
+        const auto waited{ stopwatch.elapsed() };
+        counters_.record([waited](QueueMetrics &m) { m.lockWait += waited; });
+        return mlock;
+    }
+
+    template<typename T, typename QueueType, typename WaitStrategy>
+    template<typename Predicate>
+    void SimpleQueue<T, QueueType, WaitStrategy>::wait(std::unique_lock<std::mutex> &mlock,
+        Predicate ready) {
+        if (ready()) return;
+        Stopwatch stopwatch;
+        cond_.wait(mlock, ready);
+        const auto blocked{ stopwatch.elapsed() };
+        counters_.record([blocked](QueueMetrics &m) { m.popBlocked += blocked; });
+    }
+
+    template<typename T, typename QueueType, typename WaitStrategy>
+    template<typename Clock, typename Duration, typename Predicate>
+    bool SimpleQueue<T, QueueType, WaitStrategy>::waitUntil(std::unique_lock<std::mutex> &mlock,
+        const std::chrono::time_point<Clock, Duration> &deadline,
+        Predicate ready) {
+        if (ready()) return true;
+        Stopwatch stopwatch;
+        const bool isReady{ cond_.waitUntil(mlock, deadline, ready) };
+        const auto blocked{ stopwatch.elapsed() };
+        counters_.record([blocked](QueueMetrics &m) { m.popBlocked += blocked; });
+        return isReady;
+    }
+
+    template<typename T, typename QueueType, typename WaitStrategy>
+    void SimpleQueue<T, QueueType, WaitStrategy>::recordPush() {
+        counters_.record([this](QueueMetrics &m) {
+            ++m.pushed;
+            m.highWaterMark = std::max(m.highWaterMark, queue_.size());
+        });
+    }
+
+    template<typename T, typename QueueType, typename WaitStrategy>
+    void SimpleQueue<T, QueueType, WaitStrategy>::recordPops(size_t count) {
+        counters_.record([count](QueueMetrics &m) { m.popped += count; });
+    }
 
 }// namespace Concurrency
 }// namespace rtb
@@ -17,10 +17,17 @@
 #define rtb_SimpleQueue_h
 
 #include <queue>
+#include <vector>
 #include <thread>
 #include <mutex>
-#include <condition_variable>
 #include <optional>
+#include <chrono>
+#include <utility>
+#include "rtb/concurrency/Metrics.h"
+#include "rtb/concurrency/PopResult.h"
+#include "rtb/concurrency/RingBuffer.h"
+#include "rtb/concurrency/Listener.h"
+#include "rtb/concurrency/WaitStrategy.h"
 
 namespace rtb {
 namespace Concurrency {
@@ -41,7 +48,11 @@ namespace Concurrency {
 
     using IndexT = unsigned long long;
 
-    template<typename T, typename QueueType = std::queue<std::optional<T>>>
+    // the default storage does not allocate memory once it has grown to the largest backlog
+    // `WaitStrategy` decides how the consumers wait for new messages, see WaitStrategy.h
+    template<typename T,
+        typename QueueType = std::queue<std::optional<T>, RingBuffer<std::optional<T>>>,
+        typename WaitStrategy = BlockingWait>
     class SimpleQueue;
 
     using IndexQueue = SimpleQueue<IndexT>;
@@ -62,28 +73,82 @@ namespace Concurrency {
     using SortedIndexedDataQueue = SimpleQueue<IndexedData<T>, IndexedPriorityQueue<T>>;
 
 
-    template<typename T, typename QueueType>
+    template<typename T, typename QueueType, typename WaitStrategy>
     class SimpleQueue {
       public:
+        typedef T type;
 
         SimpleQueue() = default;
         SimpleQueue(const SimpleQueue &) = delete;// disable copying
         SimpleQueue &operator=(const SimpleQueue &) = delete;// disable assignment
         std::optional<T> pop();
+        // Non-blocking and timed pops. They return `PopResult::Ok` when a message has been
+        // stored in `item`
+        PopResult tryPop(T &item);
+        // As `tryPop`, for messages that can not be default constructed
+        PopResult tryPop(std::optional<T> &item);
+        template<typename Rep, typename Period>
+        PopResult popFor(T &item, const std::chrono::duration<Rep, Period> &timeout);
+        template<typename Clock, typename Duration>
+        PopResult popUntil(T &item, const std::chrono::time_point<Clock, Duration> &deadline);
+        // Waits for at least one message, then moves up to `maxItems` messages to `out` under a
+        // single lock. Returns the number of messages moved, 0 when the queue has been closed
+        template<typename OutputIt>
+        size_t popBatch(OutputIt out, size_t maxItems);
         size_t size();
+        // same as `size`, for symmetry with `Queue::Subscription`
+        size_t messagesToRead() const;
+        // Snapshot of the counters of the queue, see Metrics.h
+        QueueMetrics metrics() const;
+        // Allocates room for `messages` queued messages, to avoid allocating at run time
+        void reserve(size_t messages);
         void close();
         template<typename U = T, typename Q = QueueType>
         typename std::enable_if<std::is_same<Q, PriorityQueue<U>>::value,
             std::optional<T>>::type
             popIndex(IndexT idx);
+        // As `popIndex`, but gives up after `timeout`
+        template<typename Rep, typename Period, typename U = T, typename Q = QueueType>
+        typename std::enable_if<std::is_same<Q, PriorityQueue<U>>::value, PopResult>::type
+            popIndexFor(IndexT idx, T &item, const std::chrono::duration<Rep, Period> &timeout);
         std::optional<T> front();
+        // notifies `listener` when the queue has a message to read, see Listener.h
+        void attach(Listener &listener);
+        void detach(Listener &listener);
         void push(const T &item);
+        void push(T &&item);
+        // Constructs the message in place from `args`
+        template<typename... Args>
+        void emplace(Args &&...args);
+        // Pushes all the items in [first, last) under a single lock and wakes the consumers
+        // once
+        template<typename InputIt>
+        void pushRange(InputIt first, InputIt last);
 
       private:
-        void push(const std::optional<T> &item);
+        template<typename... Args>
+        void pushItem(Args &&...args);
+        // `Item` is `T` or `std::optional<T>`
+        template<typename Item, typename Clock, typename Duration>
+        PopResult popInto(Item &item, const std::chrono::time_point<Clock, Duration> &deadline);
+        // takes `mutex_`, measuring the time spent waiting for it
+        std::unique_lock<std::mutex> lock() const;
+        // wait on `cond_`, measuring the time spent blocked
+        template<typename Predicate>
+        void wait(std::unique_lock<std::mutex> &mlock, Predicate ready);
+        template<typename Clock, typename Duration, typename Predicate>
+        bool waitUntil(std::unique_lock<std::mutex> &mlock,
+            const std::chrono::time_point<Clock, Duration> &deadline,
+            Predicate ready);
+        void recordPush();
+        void recordPops(size_t count);
+        // with the lock held
+        void notifyListeners();
         QueueType queue_;
         mutable std::mutex mutex_;
-        std::condition_variable cond_;
+        WaitStrategy cond_;
+        mutable Counters<QueueMetrics> counters_;
+        std::vector<Listener *> listeners_;
     };
 }// namespace Concurrency
 }// namespace rtb
@@ -0,0 +1,156 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+namespace rtb {
+namespace Concurrency {
+
+    template<typename T>
+    SpscQueue<T>::SpscQueue(std::size_t capacity)
+        : mask_(0) {
+        std::size_t size{ 2 };
+        while (size < capacity)
+            size <<= 1;
+        mask_ = size - 1;
+        slots_.reset(new std::optional<T>[size]);
+    }
+
+    template<typename T>
+    void SpscQueue<T>::reset() {
+        for (std::size_t i{ 0 }; i <= mask_; ++i)
+            slots_[i].reset();
+        head_.store(0, std::memory_order_relaxed);
+        cachedTail_ = 0;
+        tail_.store(0, std::memory_order_release);
+        cachedHead_ = 0;
+    }
+
+    template<typename T>
+    std::optional<T> SpscQueue<T>::pop() {
+        std::optional<T> item;
+        while (!dequeue(item)) {
+            notEmpty_.wait([this]() {
+                return head_.load(std::memory_order_relaxed)
+                       != tail_.load(std::memory_order_acquire);
+            });
+        }
+        return item;
+    }
+
+    template<typename T>
+    PopResult SpscQueue<T>::tryPop(T &item) {
+        return popUntil(item, std::chrono::steady_clock::time_point{});
+    }
+
+    template<typename T>
+    template<typename Rep, typename Period>
+    PopResult SpscQueue<T>::popFor(T &item, const std::chrono::duration<Rep, Period> &timeout) {
+        return popUntil(item, std::chrono::steady_clock::now() + timeout);
+    }
+
+    template<typename T>
+    template<typename Clock, typename Duration>
+    PopResult SpscQueue<T>::popUntil(T &item,
+        const std::chrono::time_point<Clock, Duration> &deadline) {
+        std::optional<T> val;
+        if (!dequeue(val)) {
+            if (Clock::now() >= deadline) return PopResult::Timeout;
+            notEmpty_.waitUntil(deadline, [this]() {
+                return head_.load(std::memory_order_relaxed)
+                       != tail_.load(std::memory_order_acquire);
+            });
+            if (!dequeue(val)) return PopResult::Timeout;
+        }
+        if (!val) return PopResult::Closed;
+        item = std::move(val.value());
+        return PopResult::Ok;
+    }
+
+    template<typename T>
+    void SpscQueue<T>::push(const T &item) {
+        pushBlocking(std::optional<T>{ item });
+    }
+
+    template<typename T>
+    void SpscQueue<T>::push(T &&item) {
+        pushBlocking(std::optional<T>{ std::move(item) });
+    }
+
+    template<typename T>
+    bool SpscQueue<T>::tryPush(const T &item) {
+        if (!enqueue(item)) return false;
+        notEmpty_.notifyAll();
+        return true;
+    }
+
+    template<typename T>
+    bool SpscQueue<T>::tryPush(T &&item) {
+        if (!enqueue(std::move(item))) return false;
+        notEmpty_.notifyAll();
+        return true;
+    }
+
+    template<typename T>
+    void SpscQueue<T>::close() {
+        pushBlocking(std::optional<T>{});
+    }
+
+    template<typename T>
+    template<typename U>
+    void SpscQueue<T>::pushBlocking(U &&item) {
+        while (!enqueue(std::move(item))) {
+            notFull_.wait([this]() {
+                return tail_.load(std::memory_order_relaxed)
+                           - head_.load(std::memory_order_acquire)
+                       <= mask_;
+            });
+        }
+        notEmpty_.notifyAll();
+    }
+
+    template<typename T>
+    template<typename U>
+    bool SpscQueue<T>::enqueue(U &&item) {
+        const std::size_t tail{ tail_.load(std::memory_order_relaxed) };
+        if (tail - cachedHead_ > mask_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ > mask_) return false;
+        }
+        slots_[tail & mask_] = std::forward<U>(item);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename T>
+    bool SpscQueue<T>::dequeue(std::optional<T> &item) {
+        const std::size_t head{ head_.load(std::memory_order_relaxed) };
+        if (head == cachedTail_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head == cachedTail_) return false;
+        }
+        item = std::move(slots_[head & mask_]);
+        slots_[head & mask_].reset();
+        head_.store(head + 1, std::memory_order_release);
+        notFull_.notifyAll();
+        return true;
+    }
+
+    template<typename T>
+    std::size_t SpscQueue<T>::size() const {
+        const std::size_t head{ head_.load(std::memory_order_acquire) };
+        return tail_.load(std::memory_order_acquire) - head;
+    }
+
+}// namespace Concurrency
+}// namespace rtb
@@ -0,0 +1,93 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_SpscQueue_h
+#define rtb_SpscQueue_h
+
+#include "rtb/concurrency/CacheLine.h"
+#include "rtb/concurrency/EventCount.h"
+#include "rtb/concurrency/PopResult.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+namespace rtb {
+namespace Concurrency {
+    //   SpscQueue - a bounded ring for links with exactly one producer and one consumer, with
+    //               the same push/pop/close API of `SimpleQueue`:
+    //               - the producer only writes the tail and the consumer only writes the head,
+    //                 each on its own cache line, so `push` and `pop` are wait-free when the
+    //                 ring is neither full nor empty
+    //               - each side keeps a cached copy of the other side's index, and reads the
+    //                 shared one only when the ring looks full or empty
+    //               - `push` waits while the ring is full, `pop` waits while it is empty
+    //               Using it from more than one producer or consumer thread is undefined.
+    template<typename T>
+    class SpscQueue {
+      public:
+        typedef T type;
+
+        // `capacity` is rounded up to the next power of two
+        explicit SpscQueue(std::size_t capacity = 1024);
+        SpscQueue(const SpscQueue &) = delete;
+        SpscQueue &operator=(const SpscQueue &) = delete;
+        // returns no value when the queue has been closed
+        std::optional<T> pop();
+        // Non-blocking and timed pops. They return `PopResult::Ok` when a message has been
+        // stored in `item`
+        PopResult tryPop(T &item);
+        template<typename Rep, typename Period>
+        PopResult popFor(T &item, const std::chrono::duration<Rep, Period> &timeout);
+        template<typename Clock, typename Duration>
+        PopResult popUntil(T &item, const std::chrono::time_point<Clock, Duration> &deadline);
+        void push(const T &item);
+        void push(T &&item);
+        // Pushes `item` unless the ring is full. Returns false, and leaves `item` untouched, in
+        // that case
+        bool tryPush(const T &item);
+        bool tryPush(T &&item);
+        void close();
+        // approximate number of queued messages, end of stream included
+        std::size_t size() const;
+        std::size_t capacity() const { return mask_ + 1; }
+        // Empties the ring, end of stream included, as it was when constructed. Neither the
+        // producer nor the consumer may use the ring meanwhile
+        void reset();
+
+      private:
+        template<typename U>
+        bool enqueue(U &&item);
+        bool dequeue(std::optional<T> &item);
+        template<typename U>
+        void pushBlocking(U &&item);
+
+        std::size_t mask_;
+        std::unique_ptr<std::optional<T>[]> slots_;
+        // consumer side: next slot to read, and the last tail it has seen
+        alignas(CacheLineSize) std::atomic<std::size_t> head_{ 0 };
+        std::size_t cachedTail_{ 0 };
+        // producer side: next slot to write, and the last head it has seen
+        alignas(CacheLineSize) std::atomic<std::size_t> tail_{ 0 };
+        std::size_t cachedHead_{ 0 };
+        alignas(CacheLineSize) EventCount notEmpty_;
+        EventCount notFull_;
+    };
+}// namespace Concurrency
+}// namespace rtb
+
+#include "SpscQueue.cpp"
+#endif
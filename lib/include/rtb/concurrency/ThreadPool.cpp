@@ -1,3 +1,4 @@
+#include <functional>
 #include <vector>
 #include <thread>
 #include <utility>
@@ -9,148 +10,311 @@ namespace Concurrency {
     ExecutionPool<InputData, OutputData>::ExecutionPool(InputQueue &inputQueue,
         OutputQueue &outputQueue,
         unsigned numberOfWorkers)
-        : inputQueue_(inputQueue)
+        // the workers, the jobs creator and the sorter
+        : ownWorkerPool_(std::make_unique<WorkerPool>(numberOfWorkers + 2))
+        , workerPool_(*ownWorkerPool_)
+        , inputQueue_(inputQueue)
+        , outputQueue_(outputQueue)
+        , numberOfWorkers_(numberOfWorkers)
+        , mode_(ExecutionMode::Dispatched)
+        , jobsQueue_(JobsCapacity)
+        , processedJobsQueue_(JobsCapacity)
+        , sequenceQueue_(JobsCapacity)
+
+    {}
+
+    template<typename InputData, typename OutputData>
+    ExecutionPool<InputData, OutputData>::ExecutionPool(InputQueue &inputQueue,
+        OutputQueue &outputQueue,
+        unsigned numberOfWorkers,
+        WorkerPool &workerPool)
+        : workerPool_(workerPool)
+        , inputQueue_(inputQueue)
         , outputQueue_(outputQueue)
         , numberOfWorkers_(numberOfWorkers)
+        , mode_(ExecutionMode::Dispatched)
+        , jobsQueue_(JobsCapacity)
+        , processedJobsQueue_(JobsCapacity)
+        , sequenceQueue_(JobsCapacity)
 
     {}
 
+    template<typename InputData, typename OutputData>
+    void ExecutionPool<InputData, OutputData>::setMode(ExecutionMode mode) {
+        mode_ = mode;
+    }
+
+    template<typename InputData, typename OutputData>
+    ExecutionPoolMetrics ExecutionPool<InputData, OutputData>::metrics() const {
+        ExecutionPoolMetrics snapshot;
+        snapshot.dispatched = counters_.dispatched.value();
+        snapshot.processed = counters_.processed.value();
+        snapshot.published = counters_.published.value();
+        snapshot.busy = std::chrono::nanoseconds(counters_.busy.value());
+        snapshot.reorderWait = std::chrono::nanoseconds(counters_.reorderWait.value());
+        return snapshot;
+    }
+
     template<typename InputData, typename OutputData>
     template<typename Funct, typename... Args>
     void ExecutionPool<InputData, OutputData>::operator()(Funct funct, Args... args) {
-        IndexedDataQueue<InputData> jobsQueue;
-        SortedIndexedDataQueue<InputData> processedJobsQueue;
-        SimpleQueue<IndexT> sequenceQueue;
+        run(nullptr, funct, args...);
+    }
+
+    template<typename InputData, typename OutputData>
+    template<typename Funct, typename... Args>
+    void ExecutionPool<InputData, OutputData>::operator()(Latch &latch, Funct funct, Args... args) {
+        run(&latch, funct, args...);
+    }
+
+    template<typename InputData, typename OutputData>
+    template<typename Funct, typename... Args>
+    void ExecutionPool<InputData, OutputData>::run(Latch *latch, Funct funct, Args... args) {
+        if (mode_ != ExecutionMode::Dispatched) {
+            runInline(latch, funct, args...);
+            return;
+        }
+        if (latch) latch->wait();
+        // the previous run has drained them, but its last indices are still recorded
+        jobsQueue_.reset();
+        processedJobsQueue_.reset();
+        sequenceQueue_.reset();
         Latch internalLatch(numberOfWorkers_ + 3);
-        JobsCreator<InputData> jobCreator(inputQueue_, jobsQueue, sequenceQueue, internalLatch, numberOfWorkers_);
+        JobsCreator<InputData> jobCreator(inputQueue_, jobsQueue_, sequenceQueue_, internalLatch, numberOfWorkers_, counters_);
         MessageSorter<OutputData> messageSorter(
-            processedJobsQueue, sequenceQueue, outputQueue_, internalLatch);
+            processedJobsQueue_, sequenceQueue_, outputQueue_, internalLatch, counters_);
         std::vector<std::shared_ptr<Worker<Funct>>> workers;
         for (unsigned i(0); i < numberOfWorkers_; ++i) {
             workers.emplace_back(
-                std::make_shared<Worker<Funct>>(jobsQueue, processedJobsQueue, internalLatch, funct));
+                std::make_shared<Worker<Funct>>(
+                    jobsQueue_, processedJobsQueue_, internalLatch, funct, counters_));
         }
 
-        std::vector<std::thread> workersThreads;
+        // the threads of the run come from `workerPool_`, `done` replaces joining them
+        WaitGroup done(numberOfWorkers_ + 2);
+        std::vector<std::function<void()>> tasks;
         for (auto &it : workers)
-            workersThreads.emplace_back(std::ref(*it), std::forward<Args>(args)...);
+            tasks.emplace_back([&worker = *it, &done, args...]() mutable {
+                worker(std::forward<Args>(args)...);
+                done.done();
+            });
+        tasks.emplace_back([&jobCreator, &done]() {
+            jobCreator();
+            done.done();
+        });
+        tasks.emplace_back([&messageSorter, &done]() {
+            messageSorter();
+            done.done();
+        });
 
-        std::thread jobCreatorThread(std::ref(jobCreator));
-        std::thread messageSorterThread(std::ref(messageSorter));
+        for (auto &it : tasks)
+            workerPool_.post([](void *task) { (*static_cast<std::function<void()> *>(task))(); },
+                &it);
         internalLatch.wait();
-        for (auto &it : workersThreads)
-            it.join();
-
-        jobCreatorThread.join();
-        messageSorterThread.join();
+        done.wait();
     }
 
-    // to factorize this with the other operator()() without latch
     template<typename InputData, typename OutputData>
     template<typename Funct, typename... Args>
-    void ExecutionPool<InputData, OutputData>::operator()(Latch &latch, Funct funct, Args... args) {
-        IndexedDataQueue<InputData> jobsQueue;
-        SortedIndexedDataQueue<InputData> processedJobsQueue;
-        SimpleQueue<IndexT> sequenceQueue;
-
-        Latch internalLatch(numberOfWorkers_+3);
-        JobsCreator<InputData> jobCreator(inputQueue_, jobsQueue, sequenceQueue, internalLatch, numberOfWorkers_);
-        MessageSorter<OutputData> messageSorter(
-            processedJobsQueue, sequenceQueue, outputQueue_, internalLatch);
-        std::vector<std::shared_ptr<Worker<Funct>>> workers;
+    void ExecutionPool<InputData, OutputData>::runInline(Latch *latch,
+        Funct funct,
+        Args... args) {
+        if (latch) latch->wait();
+        Sequencer<InputData, OutputData> sequencer(inputQueue_,
+            outputQueue_,
+            numberOfWorkers_,
+            mode_ == ExecutionMode::Inline,
+            counters_);
+        Latch internalLatch(numberOfWorkers_ + 1);
+        std::vector<std::shared_ptr<InlineWorker<Funct>>> workers;
         for (unsigned i(0); i < numberOfWorkers_; ++i) {
-            workers.emplace_back(std::make_shared<Worker<Funct>>(
-                jobsQueue, processedJobsQueue, internalLatch, funct));
+            workers.emplace_back(std::make_shared<InlineWorker<Funct>>(
+                sequencer, internalLatch, funct, counters_));
         }
 
-        latch.wait();
-        std::vector<std::thread> workersThreads;
+        WaitGroup done(numberOfWorkers_);
+        std::vector<std::function<void()>> tasks;
         for (auto &it : workers)
-            workersThreads.emplace_back(std::ref(*it), std::forward<Args>(args)...);
+            tasks.emplace_back([&worker = *it, &done, args...]() mutable {
+                worker(std::forward<Args>(args)...);
+                done.done();
+            });
 
-        std::thread jobCreatorThread(std::ref(jobCreator));
-        std::thread messageSorterThread(std::ref(messageSorter));
+        for (auto &it : tasks)
+            workerPool_.post([](void *task) { (*static_cast<std::function<void()> *>(task))(); },
+                &it);
         internalLatch.wait();
-        for (auto &it : workersThreads)
-            it.join();
-
-        jobCreatorThread.join();
-        messageSorterThread.join();
+        done.wait();
     }
 
     template<typename Funct>
     Worker<Funct>::Worker(InputQueue &inputQueue,
         OutputQueue &outputQueue,
         Latch &latch,
-        Funct funct)
+        Funct funct,
+        ExecutionPoolCounters &counters)
         : inputQueue_(inputQueue)
         , outputQueue_(outputQueue)
         , latch_(latch)
-        , funct_(funct) {}
+        , funct_(funct)
+        , counters_(counters) {}
 
     template<typename Funct>
     template<typename... Args>
     void Worker<Funct>::operator()(Args... args) {
         latch_.wait();
-      while (auto inData{ inputQueue_.pop() }) {
+        while (auto inData{ inputQueue_.pop() }) {
+            Stopwatch stopwatch;
             auto functOutput = funct_(std::get<1>(inData.value()), std::forward<Args>(args)...);
-            IndexedData<OutputData> outData;
-            std::get<0>(outData) = std::get<0>(inData.value());
-            std::get<1>(outData) = std::move(functOutput);
-            outputQueue_.push(outData);
+            counters_.busy.add(stopwatch.elapsed());
+            outputQueue_.push(std::get<0>(inData.value()), std::move(functOutput));
+            counters_.processed.add(1);
         }
-        outputQueue_.close();
     }
 
     template<typename T>
     JobsCreator<T>::JobsCreator(Queue<T> &inputQueue,
-        IndexedDataQueue<T> &outputJobsQueue,
-        IndexQueue &outputSequenceQueue,
+        IndexedDataMpmcQueue<T> &outputJobsQueue,
+        IndexSpscQueue &outputSequenceQueue,
         Latch &latch,
-        unsigned numberOfWorkers)
-        : inputQueue_(inputQueue)
+        unsigned numberOfWorkers,
+        ExecutionPoolCounters &counters)
+        : input_(inputQueue.subscribeUnbound())
         , outputJobsQueue_(outputJobsQueue)
         , outputSequenceQueue_(outputSequenceQueue)
         , latch_(latch)
         , idx_(0)
-        , numberOfWorkers_(numberOfWorkers) {}
+        , numberOfWorkers_(numberOfWorkers)
+        , counters_(counters) {}
+
+    template<typename T>
+    JobsCreator<T>::~JobsCreator() {
+        if (input_.isSubscribed()) input_.unsubscribe();
+    }
 
     template<typename T>
     void JobsCreator<T>::operator()() {
-        inputQueue_.subscribe();
         latch_.wait();
-        while (auto data{ inputQueue_.pop() }) {
+        while (auto data{ input_.pop() }) {
             IndexedData<T> iData{ idx_, std::move(data.value()) };
-            outputJobsQueue_.push(iData);
+            outputJobsQueue_.push(std::move(iData));
             outputSequenceQueue_.push(idx_);
+            counters_.dispatched.add(1);
             ++idx_;
         }
         for (unsigned i(0); i < numberOfWorkers_; ++i)
             outputJobsQueue_.close();
         outputSequenceQueue_.close();
-        inputQueue_.unsubscribe();
+        input_.unsubscribe();
     }
 
     template<typename T>
-    MessageSorter<T>::MessageSorter(SortedIndexedDataQueue<T> &inputFromThreadPool,
-        IndexQueue &inputSequence,
+    MessageSorter<T>::MessageSorter(ReorderBuffer<T> &inputFromThreadPool,
+        IndexSpscQueue &inputSequence,
         Queue<T> &outputQueue,
-        Latch &latch)
+        Latch &latch,
+        ExecutionPoolCounters &counters)
         : inputFromThreadPool_(inputFromThreadPool)
         , inputSequence_(inputSequence)
         , outputQueue_(outputQueue)
-        , latch_(latch) {}
+        , latch_(latch)
+        , counters_(counters) {}
 
     template<typename T>
     void MessageSorter<T>::operator()() {
         latch_.wait();
-        while (auto inputSequenceResult{ inputSequence_.pop() }) {
-            IndexT idx{ inputSequenceResult.value() };
-            auto val{ inputFromThreadPool_.popIndex(idx) };
-            if (val.has_value()) { outputQueue_.push(std::get<1>(val.value())); }
+        // each index announces one result, released in index order
+        while (inputSequence_.pop()) {
+            Stopwatch stopwatch;
+            auto val{ inputFromThreadPool_.pop() };
+            counters_.reorderWait.add(stopwatch.elapsed());
+            outputQueue_.push(std::move(val));
+            counters_.published.add(1);
         }
         outputQueue_.close();
     }
 
+    template<typename InputData, typename OutputData>
+    Sequencer<InputData, OutputData>::Sequencer(Queue<InputData> &inputQueue,
+        Queue<OutputData> &outputQueue,
+        unsigned numberOfWorkers,
+        bool ordered,
+        ExecutionPoolCounters &counters)
+        : input_(inputQueue.subscribeUnbound())
+        , claimed_(0)
+        , closed_(false)
+        , outputQueue_(outputQueue)
+        , ordered_(ordered)
+        , published_(0)
+        , activeWorkers_(numberOfWorkers)
+        , counters_(counters) {}
+
+    template<typename InputData, typename OutputData>
+    Sequencer<InputData, OutputData>::~Sequencer() {
+        if (input_.isSubscribed()) input_.unsubscribe();
+    }
+
+    template<typename InputData, typename OutputData>
+    std::optional<IndexedData<InputData>> Sequencer<InputData, OutputData>::claim() {
+        std::lock_guard<std::mutex> mlock(inputMutex_);
+        // the subscription returns the end of stream once, the other workers see `closed_`
+        if (closed_) return std::nullopt;
+        auto data{ input_.pop() };
+        if (!data) {
+            closed_ = true;
+            return std::nullopt;
+        }
+        counters_.dispatched.add(1);
+        return IndexedData<InputData>{ claimed_++, std::move(data.value()) };
+    }
+
+    template<typename InputData, typename OutputData>
+    void Sequencer<InputData, OutputData>::publish(IndexT idx, OutputData &&item) {
+        if (!ordered_) {
+            outputQueue_.push(std::move(item));
+            counters_.published.add(1);
+            return;
+        }
+        Stopwatch stopwatch;
+        turn_.wait([this, idx]() { return published_.load(std::memory_order_acquire) == idx; });
+        counters_.reorderWait.add(stopwatch.elapsed());
+        outputQueue_.push(std::move(item));
+        counters_.published.add(1);
+        published_.store(idx + 1, std::memory_order_release);
+        turn_.notifyAll();
+    }
+
+    template<typename InputData, typename OutputData>
+    void Sequencer<InputData, OutputData>::finish() {
+        // each worker has published its results before finishing
+        if (activeWorkers_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            outputQueue_.close();
+    }
+
+    template<typename Funct>
+    InlineWorker<Funct>::InlineWorker(Sequencer<InputData, OutputData> &sequencer,
+        Latch &latch,
+        Funct funct,
+        ExecutionPoolCounters &counters)
+        : sequencer_(sequencer)
+        , latch_(latch)
+        , funct_(funct)
+        , counters_(counters) {}
+
+    template<typename Funct>
+    template<typename... Args>
+    void InlineWorker<Funct>::operator()(Args... args) {
+        latch_.wait();
+        while (auto inData{ sequencer_.claim() }) {
+            Stopwatch stopwatch;
+            // `args` are passed to every call, so they are not forwarded
+            auto functOutput = funct_(std::get<1>(inData.value()), args...);
+            counters_.busy.add(stopwatch.elapsed());
+            counters_.processed.add(1);
+            sequencer_.publish(std::get<0>(inData.value()), std::move(functOutput));
+        }
+        sequencer_.finish();
+    }
+
 }// namespace Concurrency
 }// namespace rtb
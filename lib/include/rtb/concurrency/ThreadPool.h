@@ -15,9 +15,19 @@
 #ifndef rtb_ThreadPool_h
 #define rtb_ThreadPool_h
 
+#include "rtb/concurrency/CacheLine.h"
+#include "rtb/concurrency/EventCount.h"
+#include "rtb/concurrency/MpmcQueue.h"
 #include "rtb/concurrency/Queue.h"
+#include "rtb/concurrency/ReorderBuffer.h"
 #include "rtb/concurrency/SimpleQueue.h"
+#include "rtb/concurrency/SpscQueue.h"
 #include "rtb/concurrency/Latch.h"
+#include "rtb/concurrency/Metrics.h"
+#include "rtb/concurrency/WorkerPool.h"
+#include <atomic>
+#include <mutex>
+#include <optional>
 #include <queue>
 #include <tuple>
 #include <memory>
@@ -27,30 +37,61 @@ namespace rtb {
 
 namespace Concurrency {
 
+    // order of the jobs, from the `JobsCreator` to the `MessageSorter` (a 1:1 link)
+    using IndexSpscQueue = SpscQueue<IndexT>;
+
+    // counters shared by the threads of an `ExecutionPool`, see `ExecutionPoolMetrics`
+    struct ExecutionPoolCounters {
+        Tally dispatched;
+        Tally processed;
+        Tally published;
+        Tally busy;
+        Tally reorderWait;
+    };
+
+    // How the messages go through an `ExecutionPool`, see `ExecutionPool::setMode`
+    enum class ExecutionMode {
+        // a `JobsCreator` and a `MessageSorter` thread dispatch the messages to the workers and
+        // put the results back in order
+        Dispatched,
+        // the workers take the messages from the input themselves and publish the results in
+        // order, see `Sequencer`. Two threads and three hand-offs fewer per message, but a
+        // worker waits for the results before its own to be published
+        Inline,
+        // as `Inline`, but each result is published as soon as it is ready, so a slow message
+        // does not hold back the results after it. For consumers that do not need the order
+        Unordered
+    };
+
     template<typename T>
     class JobsCreator {
         /* Tags each of the input messages with a unique identifier
          * dispatch messages to each of the workers and stores the order of the messages to
          * `outputSequenceQueue`
-         *
+         * It subscribes to the input when it is constructed, through a handle that is not bound
+         * to the calling thread, and unsubscribes at the end of the stream or when destroyed.
          */
       public:
+        using Subscription = typename Queue<T>::Subscription;
         JobsCreator() = delete;
         JobsCreator(JobsCreator &) = delete;
         JobsCreator(Queue<T> &inputQueue,
-            IndexedDataQueue<T> &outputJobsQueue,
-            IndexQueue &outputSequenceQueue,
+            IndexedDataMpmcQueue<T> &outputJobsQueue,
+            IndexSpscQueue &outputSequenceQueue,
             Latch & latch,
-            unsigned numberOfWorkers);
+            unsigned numberOfWorkers,
+            ExecutionPoolCounters &counters);
+        ~JobsCreator();
         void operator()();
 
       private:
-        Queue<T> &inputQueue_;
-        IndexedDataQueue<T> &outputJobsQueue_;
-        IndexQueue &outputSequenceQueue_;
+        Subscription input_;
+        IndexedDataMpmcQueue<T> &outputJobsQueue_;
+        IndexSpscQueue &outputSequenceQueue_;
         IndexT idx_;
         Latch &latch_;
         unsigned numberOfWorkers_;
+        ExecutionPoolCounters &counters_;
     };
 
     template<typename T>
@@ -60,17 +101,19 @@ namespace Concurrency {
          */
       public:
         MessageSorter() = delete;
-        MessageSorter(SortedIndexedDataQueue<T> &inputFromThreadPool,
-            IndexQueue &inputSequence,
+        MessageSorter(ReorderBuffer<T> &inputFromThreadPool,
+            IndexSpscQueue &inputSequence,
             Queue<T> &outputQueue,
-            Latch& latch);
+            Latch& latch,
+            ExecutionPoolCounters &counters);
         void operator()();
 
       private:
-        SortedIndexedDataQueue<T> &inputFromThreadPool_;
-        IndexQueue &inputSequence_;
+        ReorderBuffer<T> &inputFromThreadPool_;
+        IndexSpscQueue &inputSequence_;
         Queue<T> &outputQueue_;
         Latch &latch_;
+        ExecutionPoolCounters &counters_;
     };
 
     template<typename Funct>
@@ -78,9 +121,13 @@ namespace Concurrency {
       public:
         using InputData = typename Funct::InputData;
         using OutputData = typename Funct::OutputData;
-        using InputQueue = IndexedDataQueue<InputData>;
-        using OutputQueue = SortedIndexedDataQueue<OutputData>;
-        Worker(InputQueue &inputQueue, OutputQueue &outputQueue, Latch& latch, Funct funct);
+        using InputQueue = IndexedDataMpmcQueue<InputData>;
+        using OutputQueue = ReorderBuffer<OutputData>;
+        Worker(InputQueue &inputQueue,
+            OutputQueue &outputQueue,
+            Latch &latch,
+            Funct funct,
+            ExecutionPoolCounters &counters);
         template<typename... Args>
         void operator()(Args... args);
 
@@ -89,6 +136,63 @@ namespace Concurrency {
         OutputQueue &outputQueue_;
         Latch &latch_;
         Funct funct_;
+        ExecutionPoolCounters &counters_;
+    };
+
+    template<typename InputData, typename OutputData>
+    class Sequencer {
+        /* Shared by the workers of an inline or unordered run of an `ExecutionPool`. Hands out
+         * the input messages tagged with consecutive indices, and publishes the results to the
+         * output, in the order of the indices when `ordered`. The last worker to finish closes
+         * the output. It subscribes to the input when it is constructed, through a handle that
+         * is not bound to the calling thread, and unsubscribes when it is destroyed.
+         */
+      public:
+        using Subscription = typename Queue<InputData>::Subscription;
+        Sequencer() = delete;
+        Sequencer(Sequencer &) = delete;
+        Sequencer(Queue<InputData> &inputQueue,
+            Queue<OutputData> &outputQueue,
+            unsigned numberOfWorkers,
+            bool ordered,
+            ExecutionPoolCounters &counters);
+        ~Sequencer();
+        // the next input message and its index, no value at the end of the stream
+        std::optional<IndexedData<InputData>> claim();
+        // when `ordered`, waits until the results before `idx` have been published
+        void publish(IndexT idx, OutputData &&item);
+        void finish();
+
+      private:
+        Subscription input_;
+        std::mutex inputMutex_;
+        IndexT claimed_;
+        bool closed_;
+        Queue<OutputData> &outputQueue_;
+        bool ordered_;
+        alignas(CacheLineSize) std::atomic<IndexT> published_;
+        EventCount turn_;
+        std::atomic<unsigned> activeWorkers_;
+        ExecutionPoolCounters &counters_;
+    };
+
+    template<typename Funct>
+    class InlineWorker {
+      public:
+        using InputData = typename Funct::InputData;
+        using OutputData = typename Funct::OutputData;
+        InlineWorker(Sequencer<InputData, OutputData> &sequencer,
+            Latch &latch,
+            Funct funct,
+            ExecutionPoolCounters &counters);
+        template<typename... Args>
+        void operator()(Args... args);
+
+      private:
+        Sequencer<InputData, OutputData> &sequencer_;
+        Latch &latch_;
+        Funct funct_;
+        ExecutionPoolCounters &counters_;
     };
 
     template<typename InputData, typename OutputData>
@@ -98,17 +202,47 @@ namespace Concurrency {
         using OutputQueue = Queue<OutputData>;
         ExecutionPool() = delete;
         ExecutionPool(ExecutionPool &) = delete;
+        // the runs use threads of the pool's own, spawned here and kept for the next runs
         ExecutionPool(InputQueue &inputQueue, OutputQueue &outputQueue, unsigned numberOfWorkers);
+        // the runs use the threads of `workerPool`, shared with other pools or pipelines.
+        // `workerPool` must outlive the runs
+        ExecutionPool(InputQueue &inputQueue,
+            OutputQueue &outputQueue,
+            unsigned numberOfWorkers,
+            WorkerPool &workerPool);
 
+        // A run processes the input until it is closed. The runs of a pool reuse its internal
+        // queues, so they must not overlap
         template<typename Funct, typename... Args>
         void operator()(Funct funct, Args... args);
         template<typename Funct, typename... Args>
         void operator()(Latch &latch, Funct funct, Args... args);
+        // `ExecutionMode::Dispatched` by default. Call it before the runs start
+        void setMode(ExecutionMode mode);
+        // Snapshot of the counters of all the runs of the pool, see Metrics.h
+        ExecutionPoolMetrics metrics() const;
 
       private:
+        // the jobs and the sequence queues are bounded, the dispatcher waits when the workers
+        // or the sorter are this far behind
+        static constexpr std::size_t JobsCapacity{ 1024 };
+        // `latch`, when not null, is waited for before the run starts
+        template<typename Funct, typename... Args>
+        void run(Latch *latch, Funct funct, Args... args);
+        // `ExecutionMode::Inline` and `ExecutionMode::Unordered` runs
+        template<typename Funct, typename... Args>
+        void runInline(Latch *latch, Funct funct, Args... args);
+        std::unique_ptr<WorkerPool> ownWorkerPool_;
+        WorkerPool &workerPool_;
         InputQueue &inputQueue_;
         OutputQueue &outputQueue_;
         unsigned numberOfWorkers_;
+        ExecutionMode mode_;
+        ExecutionPoolCounters counters_;
+        // links of the dispatched runs, allocated once and reset at the start of each run
+        IndexedDataMpmcQueue<InputData> jobsQueue_;
+        ReorderBuffer<OutputData> processedJobsQueue_;
+        IndexSpscQueue sequenceQueue_;
     };
 
     template<typename InputData, typename OutputData>
@@ -121,6 +255,17 @@ namespace Concurrency {
             (inputQueue, outputQueue, numberOfWorkers);
     }
 
+    template<typename InputData, typename OutputData>
+    auto makeExecutionPool(
+        Queue<InputData> &inputQueue,
+        Queue<OutputData> &outputQueue,
+        unsigned numberOfWorkers,
+        WorkerPool &workerPool) {
+
+        return std::make_shared<ExecutionPool<InputData, OutputData>>(
+            inputQueue, outputQueue, numberOfWorkers, workerPool);
+    }
+
 }// namespace Concurrency
 }// namespace rtb
 #include "ThreadPool.cpp"
@@ -0,0 +1,73 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+namespace rtb {
+namespace Concurrency {
+
+    template<typename Relax>
+    template<typename Predicate>
+    void SpinningWait<Relax>::wait(std::unique_lock<std::mutex> &lock, Predicate ready) {
+        while (!ready())
+            awaitNotification(lock, []() { return false; });
+    }
+
+    template<typename Relax>
+    template<typename Clock, typename Duration, typename Predicate>
+    bool SpinningWait<Relax>::waitUntil(std::unique_lock<std::mutex> &lock,
+        const std::chrono::time_point<Clock, Duration> &deadline,
+        Predicate ready) {
+        while (!ready()) {
+            if (Clock::now() >= deadline) return false;
+            awaitNotification(lock, [&deadline]() { return Clock::now() >= deadline; });
+        }
+        return true;
+    }
+
+    template<typename Relax>
+    template<typename GiveUp>
+    bool SpinningWait<Relax>::awaitNotification(std::unique_lock<std::mutex> &lock,
+        GiveUp giveUp) {
+        // read with the lock held: a notification for a state change we have not seen yet
+        // comes after this value
+        const unsigned seen{ notifications_.load(std::memory_order_acquire) };
+        lock.unlock();
+        bool notified{ false };
+        while (!(notified = notifications_.load(std::memory_order_acquire) != seen) && !giveUp())
+            Relax{}();
+        lock.lock();
+        return notified;
+    }
+
+    template<typename Predicate>
+    void SpinThenParkWait::wait(std::unique_lock<std::mutex> &lock, Predicate ready) {
+        if (ready() || (spin(lock) && ready())) return;
+        parked_.fetch_add(1, std::memory_order_relaxed);
+        cond_.wait(lock, ready);
+        parked_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    template<typename Clock, typename Duration, typename Predicate>
+    bool SpinThenParkWait::waitUntil(std::unique_lock<std::mutex> &lock,
+        const std::chrono::time_point<Clock, Duration> &deadline,
+        Predicate ready) {
+        if (ready() || (spin(lock) && ready())) return true;
+        parked_.fetch_add(1, std::memory_order_relaxed);
+        bool isReady{ cond_.wait_until(lock, deadline, ready) };
+        parked_.fetch_sub(1, std::memory_order_relaxed);
+        return isReady;
+    }
+
+}// namespace Concurrency
+}// namespace rtb
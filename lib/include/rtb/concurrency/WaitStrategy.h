@@ -0,0 +1,129 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_WaitStrategy_h
+#define rtb_WaitStrategy_h
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+namespace rtb {
+namespace Concurrency {
+    // Wait strategies decide how `Queue`, `SimpleQueue` and `BasicLatch` wait for each other,
+    // trading CPU time for wake-up latency. They are used in place of a condition variable:
+    //   void wait(std::unique_lock<std::mutex> &lock, Predicate ready);
+    //   bool waitUntil(std::unique_lock<std::mutex> &lock, const time_point &deadline,
+    //                  Predicate ready);   // returns the last value of `ready()`
+    //   void notifyOne();
+    //   void notifyAll();
+    // `ready` is always evaluated with `lock` held, and the state it reads must be changed
+    // with the same mutex held, as with `std::condition_variable`.
+
+    //   BlockingWait - the waiting thread sleeps on a condition variable. Cheapest in CPU time,
+    //                  it is the default of all the primitives
+    class BlockingWait {
+      public:
+        BlockingWait() = default;
+        BlockingWait(const BlockingWait &) = delete;
+        BlockingWait &operator=(const BlockingWait &) = delete;
+        template<typename Predicate>
+        void wait(std::unique_lock<std::mutex> &lock, Predicate ready) {
+            cond_.wait(lock, ready);
+        }
+        template<typename Clock, typename Duration, typename Predicate>
+        bool waitUntil(std::unique_lock<std::mutex> &lock,
+            const std::chrono::time_point<Clock, Duration> &deadline,
+            Predicate ready) {
+            return cond_.wait_until(lock, deadline, ready);
+        }
+        void notifyOne() { cond_.notify_one(); }
+        void notifyAll() { cond_.notify_all(); }
+
+      private:
+        std::condition_variable cond_;
+    };
+
+    //   SpinningWait - the waiting thread releases the lock and polls a notification counter,
+    //                  calling `Relax` between two polls. It never sleeps, so the wake-up
+    //                  latency is the time needed to take the lock again. Use it on isolated
+    //                  cores only, see `BusySpinWait` and `YieldWait`
+    template<typename Relax>
+    class SpinningWait {
+      public:
+        SpinningWait() = default;
+        SpinningWait(const SpinningWait &) = delete;
+        SpinningWait &operator=(const SpinningWait &) = delete;
+        template<typename Predicate>
+        void wait(std::unique_lock<std::mutex> &lock, Predicate ready);
+        template<typename Clock, typename Duration, typename Predicate>
+        bool waitUntil(std::unique_lock<std::mutex> &lock,
+            const std::chrono::time_point<Clock, Duration> &deadline,
+            Predicate ready);
+        void notifyOne() { notifyAll(); }
+        void notifyAll() { notifications_.fetch_add(1, std::memory_order_release); }
+
+      protected:
+        // Releases `lock` until the next notification, or until `giveUp()` returns true.
+        // Returns true when a notification arrived
+        template<typename GiveUp>
+        bool awaitNotification(std::unique_lock<std::mutex> &lock, GiveUp giveUp);
+
+      private:
+        std::atomic<unsigned> notifications_{ 0 };
+    };
+
+    struct BusyRelax {
+        void operator()() const {}
+    };
+
+    struct YieldRelax {
+        void operator()() const { std::this_thread::yield(); }
+    };
+
+    //   BusySpinWait - lowest latency, burns a whole core while waiting
+    using BusySpinWait = SpinningWait<BusyRelax>;
+    //   YieldWait - spins, but lets other threads run on the same core between two polls
+    using YieldWait = SpinningWait<YieldRelax>;
+
+    //   SpinThenParkWait - spins for a short while, then sleeps on a condition variable.
+    //                      Notifiers only touch the condition variable when somebody sleeps
+    class SpinThenParkWait : private SpinningWait<BusyRelax> {
+      public:
+        SpinThenParkWait() = default;
+        template<typename Predicate>
+        void wait(std::unique_lock<std::mutex> &lock, Predicate ready);
+        template<typename Clock, typename Duration, typename Predicate>
+        bool waitUntil(std::unique_lock<std::mutex> &lock,
+            const std::chrono::time_point<Clock, Duration> &deadline,
+            Predicate ready);
+        void notifyOne();
+        void notifyAll();
+
+      private:
+        static constexpr unsigned SpinCount = 1024;
+        // spins for at most `SpinCount` polls, returns true when a notification arrived
+        bool spin(std::unique_lock<std::mutex> &lock);
+        // threads sleeping on `cond_`, only changed with the waiters' lock held
+        std::atomic<unsigned> parked_{ 0 };
+        std::condition_variable cond_;
+    };
+}// namespace Concurrency
+}// namespace rtb
+
+#include "WaitStrategy.cpp"
+#endif
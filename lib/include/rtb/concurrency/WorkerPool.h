@@ -0,0 +1,90 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef rtb_WorkerPool_h
+#define rtb_WorkerPool_h
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rtb {
+namespace Concurrency {
+    //   WorkerPool - long-lived threads running the work posted to them, shared by several
+    //                `ExecutionPool` runs or pipelines so that a new run does not create threads.
+    //                Unlike `Dispatcher`, each piece of work gets a thread of its own as soon as
+    //                it is posted: when no thread is idle the pool spawns one, which then stays
+    //                in the pool. Work that blocks on the other work of the same run (e.g., the
+    //                workers, the jobs creator and the sorter of an `ExecutionPool`) can not
+    //                starve, and the pool settles at the largest number of threads used at once.
+    class WorkerPool {
+      public:
+        // spawns `threads` threads up front, so that they are warm for the first run
+        explicit WorkerPool(std::size_t threads = 0);
+        WorkerPool(const WorkerPool &) = delete;
+        WorkerPool &operator=(const WorkerPool &) = delete;
+        // calls `join`
+        ~WorkerPool();
+        // runs `work(arg)` on an idle thread, or on a new one if they are all busy
+        void post(void (*work)(void *), void *arg);
+        // runs the work posted so far, then stops the threads. Nothing can be posted afterwards
+        void join();
+        // number of threads of the pool
+        std::size_t size() const;
+        // number of threads waiting for work
+        std::size_t idle() const;
+
+      private:
+        struct Work {
+            void (*run)(void *);
+            void *arg;
+        };
+        // with the lock held
+        void spawn();
+        void run();
+        mutable std::mutex mutex_;
+        std::condition_variable cond_;
+        std::deque<Work> work_;
+        std::vector<std::thread> threads_;
+        std::size_t idle_;
+        std::size_t starting_;
+        bool stopping_;
+    };
+
+    //   WaitGroup - waits for a number of pieces of work, e.g., posted to a `WorkerPool`, to be
+    //               done. `done` notifies while holding the lock, so the waiter can destroy the
+    //               group as soon as `wait` returns.
+    class WaitGroup {
+      public:
+        explicit WaitGroup(std::size_t count = 0);
+        WaitGroup(const WaitGroup &) = delete;
+        WaitGroup &operator=(const WaitGroup &) = delete;
+        void add(std::size_t count);
+        void done();
+        // waits until `done` has been called once per counted piece of work
+        void wait();
+
+      private:
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        std::size_t count_;
+    };
+}// namespace Concurrency
+}// namespace rtb
+
+#endif
@@ -0,0 +1,156 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/Coroutine.h"
+#include <iostream>
+#include <vector>
+#include <memory>
+
+using namespace rtb::Concurrency;
+
+Task addOne(SimpleQueue<int> &in, SimpleQueue<int> &out) {
+    while (auto val{ co_await popAsync(in) })
+        co_await pushAsync(out, val.value() + 1);
+    out.close();
+}
+
+Task produce(Queue<int> &q, int noMessages) {
+    for (int i{ 0 }; i < noMessages; ++i)
+        co_await pushAsync(q, i);
+    co_await closeAsync(q);
+}
+
+Task consume(Queue<int>::Subscription &subscription, std::vector<int> &consumed) {
+    while (auto val{ co_await popAsync(subscription) })
+        consumed.push_back(val.value());
+}
+
+// a message without a default constructor
+struct Sample {
+    explicit Sample(int value)
+        : value(value) {}
+    int value;
+};
+
+Task forward(SimpleQueue<Sample> &in, Queue<Sample> &out) {
+    while (auto val{ co_await popAsync(in) })
+        co_await pushAsync(out, Sample{ val->value * 2 });
+    co_await closeAsync(out);
+}
+
+Task collect(Queue<Sample>::Subscription &subscription, std::vector<int> &collected) {
+    while (auto val{ co_await popAsync(subscription) })
+        collected.push_back(val->value);
+}
+
+int test1() {
+    // FIRST TEST
+    // A pipeline of 200 coroutine stages, each adding one to the messages, runs on 2 threads
+    // OUTPUT: all the messages go through all the stages
+
+    std::cout << "\n ---------------- First Test ---------------- \n";
+    std::cout << "OUTPUT:  200 stages on 2 threads add 200 to 1000 messages\n\n";
+
+    const int noStages{ 200 };
+    const int noMessages{ 1000 };
+    std::vector<std::unique_ptr<SimpleQueue<int>>> queues;
+    for (int i{ 0 }; i <= noStages; ++i)
+        queues.push_back(std::make_unique<SimpleQueue<int>>());
+
+    Scheduler scheduler(2);
+    for (int i{ 0 }; i < noStages; ++i)
+        scheduler.spawn(addOne(*queues[i], *queues[i + 1]));
+    for (int i{ 0 }; i < noMessages; ++i)
+        queues.front()->push(i);
+    queues.front()->close();
+
+    std::vector<int> read;
+    while (auto val{ queues.back()->pop() })
+        read.push_back(val.value());
+    scheduler.join();
+
+    bool success = read.size() == noMessages;
+    for (int i{ 0 }; success && i < noMessages; ++i)
+        success &= read[i] == i + noStages;
+    return success;
+}
+
+int test2() {
+    // SECOND TEST
+    // A producer and a consumer coroutine share a bounded queue and a single thread
+    // OUTPUT: the full queue suspends the producer instead of blocking the thread, and the
+    // consumer reads all the messages
+
+    std::cout << "\n ---------------- Second Test ---------------- \n";
+    std::cout << "OUTPUT:  producer and consumer run on the same thread\n\n";
+
+    const int noMessages{ 1000 };
+    Queue<int> q(4);
+    auto subscription{ q.subscribe() };
+    std::vector<int> consumed;
+    {
+        Scheduler scheduler(1);
+        scheduler.spawn(produce(q, noMessages));
+        scheduler.spawn(consume(subscription, consumed));
+    }
+
+    bool success = consumed.size() == noMessages;
+    for (int i{ 0 }; success && i < noMessages; ++i)
+        success &= consumed[i] == i;
+    return success;
+}
+
+int test3() {
+    // THIRD TEST
+    // Messages that can not be default constructed go through a SimpleQueue and a Queue
+    // OUTPUT: the coroutines pop them from both sources
+
+    std::cout << "\n ---------------- Third Test ---------------- \n";
+    std::cout << "OUTPUT:  100 messages without a default constructor\n\n";
+
+    const int noMessages{ 100 };
+    SimpleQueue<Sample> in;
+    Queue<Sample> out(4);
+    auto subscription{ out.subscribe() };
+    std::vector<int> collected;
+    {
+        Scheduler scheduler(1);
+        scheduler.spawn(forward(in, out));
+        scheduler.spawn(collect(subscription, collected));
+        for (int i{ 0 }; i < noMessages; ++i)
+            in.push(Sample{ i });
+        in.close();
+    }
+
+    bool success = collected.size() == noMessages;
+    for (int i{ 0 }; success && i < noMessages; ++i)
+        success &= collected[i] == i * 2;
+    return success;
+}
+
+int main() {
+    if (!test1()) {
+        std::cout << "Test1 failed\n";
+        return 1;
+    }
+    if (!test2()) {
+        std::cout << "Test2 failed\n";
+        return 1;
+    }
+    if (!test3()) {
+        std::cout << "Test3 failed\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,162 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/Queue.h"
+#include "rtb/concurrency/Dispatcher.h"
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+using namespace rtb::Concurrency;
+
+int test1() {
+    // FIRST TEST
+    // Three handlers (a recorder, a counter and a threshold detector) subscribe to the same
+    // queue and share a dispatcher with two threads
+    // OUTPUT: each handler sees all the messages, in order
+
+    std::cout << "\n ---------------- First Test ---------------- \n";
+    std::cout << "OUTPUT:  3 handlers on 2 threads handle 10000 messages in order\n\n";
+
+    const int noMessages{ 10000 };
+    Dispatcher dispatcher(2);
+    Queue<int> q;
+    std::vector<int> recorded;
+    int count{ 0 };
+    int aboveThreshold{ 0 };
+    bool inOrder{ true };
+    int last{ -1 };
+
+    auto recorder{ q.subscribe([&](const int &val) { recorded.push_back(val); }, dispatcher) };
+    auto counter{ q.subscribe(
+        [&](const int &val) {
+            ++count;
+            inOrder &= (val == last + 1);
+            last = val;
+        },
+        dispatcher) };
+    auto detector{ q.subscribe(
+        [&](const int &val) {
+            if (val >= noMessages / 2) ++aboveThreshold;
+        },
+        dispatcher) };
+
+    std::thread prodThr([&]() {
+        for (int i{ 0 }; i < noMessages; ++i)
+            q.push(i);
+        q.close();
+    });
+    recorder.wait();
+    counter.wait();
+    detector.wait();
+    prodThr.join();
+
+    bool success = recorded.size() == noMessages && count == noMessages && inOrder;
+    success &= aboveThreshold == noMessages / 2;
+    for (int i{ 0 }; success && i < noMessages; ++i)
+        success &= recorded[i] == i;
+    return success;
+}
+
+int test2() {
+    // SECOND TEST
+    // A handler unsubscribes while the producer is still pushing
+    // OUTPUT: the handler is not called anymore, and the other subscriber reads everything
+
+    std::cout << "\n ---------------- Second Test ---------------- \n";
+    std::cout << "OUTPUT:  no calls after unsubscribe\n\n";
+
+    const int noMessages{ 1000 };
+    Dispatcher dispatcher(2);
+    Queue<int> q;
+    std::atomic<int> handled{ 0 };
+    auto subscription{ q.subscribe() };
+    auto callback{ q.subscribe([&](const int &) { ++handled; }, dispatcher) };
+
+    for (int i{ 0 }; i < noMessages / 2; ++i)
+        q.push(i);
+    callback.unsubscribe();
+    const int handledBefore{ handled.load() };
+    for (int i{ noMessages / 2 }; i < noMessages; ++i)
+        q.push(i);
+    q.close();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    int read{ 0 };
+    while (subscription.pop())
+        ++read;
+    bool success = !callback.isSubscribed() && handled.load() == handledBefore;
+    success &= handledBefore <= noMessages / 2 && read == noMessages;
+    return success;
+}
+
+// waits up to a second for `condition`
+template<typename Predicate>
+bool eventually(Predicate condition) {
+    for (int i{ 0 }; i < 1000 && !condition(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return condition();
+}
+
+int test3() {
+    // THIRD TEST
+    // A bounded queue drops a message for a lagging subscriber while a handler on the same
+    // queue has already handled everything
+    // OUTPUT: the handler does not hold the dispatcher, which still runs the handler of another
+    // queue, and unsubscribing returns
+
+    std::cout << "\n ---------------- Third Test ---------------- \n";
+    std::cout << "OUTPUT:  dropped message, dispatcher still free, unsubscribe returns\n\n";
+
+    Dispatcher dispatcher(1);
+    Queue<int> q(2, OverflowPolicy::DropNewest);
+    Queue<int> other;
+    std::atomic<int> handled{ 0 };
+    std::atomic<int> otherHandled{ 0 };
+    auto lagging{ q.subscribe() };
+    auto callback{ q.subscribe([&](const int &) { ++handled; }, dispatcher) };
+    auto otherCallback{ other.subscribe([&](const int &) { ++otherHandled; }, dispatcher) };
+
+    q.push(1);
+    q.push(2);
+    bool success = eventually([&]() { return handled.load() == 2; });
+    // dropped, as the lagging subscriber has not read anything
+    q.push(3);
+    other.push(1);
+    success &= eventually([&]() { return otherHandled.load() == 1; });
+    std::cout << "handled " << handled.load() << ", other queue handled " << otherHandled.load()
+              << std::endl;
+    callback.unsubscribe();
+    otherCallback.unsubscribe();
+    success &= handled.load() == 2 && lagging.messagesToRead() == 2;
+    return success;
+}
+
+int main() {
+    if (!test1()) {
+        std::cout << "Test1 failed\n";
+        return 1;
+    }
+    if (!test2()) {
+        std::cout << "Test2 failed\n";
+        return 1;
+    }
+    if (!test3()) {
+        std::cout << "Test3 failed\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,230 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/Latch.h"
+#include "rtb/concurrency/Queue.h"
+#include "rtb/concurrency/ThreadPool.h"
+#include "rtb/concurrency/WorkerPool.h"
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace rtb::Concurrency;
+
+// slower on some messages, so that the workers finish out of order
+struct AddOffset {
+    using InputData = double;
+    using OutputData = double;
+    double operator()(double value, double offset) {
+        if (static_cast<int>(value) % 7 == 0)
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        return value + offset;
+    }
+};
+
+// the first message takes much longer than the others
+struct SlowFirst {
+    using InputData = double;
+    using OutputData = double;
+    double operator()(double value) {
+        if (value == 0.)
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        return value;
+    }
+};
+
+// pushes `noMessages` messages once the pool had time to subscribe to `inputQueue`
+void produce(Queue<double> &inputQueue, int noMessages) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    for (int i{ 0 }; i < noMessages; ++i)
+        inputQueue.push(i);
+    inputQueue.close();
+}
+
+int test1() {
+    // FIRST TEST
+    // An inline execution pool processes a stream of messages that take different times
+    // OUTPUT: all the results are published, in order
+
+    std::cout << "\n ---------------- First Test ---------------- \n";
+    std::cout << "OUTPUT:  1000 results in order, published by 4 inline workers\n\n";
+
+    const int noMessages{ 1000 };
+    Queue<double> inputQueue, outputQueue;
+    auto sink{ outputQueue.subscribe() };
+    auto pool(makeExecutionPool(inputQueue, outputQueue, 4));
+    pool->setMode(ExecutionMode::Inline);
+    std::thread poolThr(std::ref(*pool), AddOffset{}, 0.5);
+    std::thread sourceThr(produce, std::ref(inputQueue), noMessages);
+    int received{ 0 };
+    bool success = true;
+    while (auto val{ sink.pop() })
+        success &= val.value() == received++ + 0.5;
+    sourceThr.join();
+    poolThr.join();
+
+    std::cout << received << " results\n";
+    success &= received == noMessages;
+    return success;
+}
+
+int test2() {
+    // SECOND TEST
+    // Inline runs started by a latch, one after the other on a shared worker pool
+    // OUTPUT: each run publishes all its results in order, on the threads of the first run
+
+    std::cout << "\n ---------------- Second Test ---------------- \n";
+    std::cout << "OUTPUT:  3 inline runs of 200 messages on 3 threads\n\n";
+
+    const int noMessages{ 200 };
+    const unsigned noWorkers{ 3 };
+    WorkerPool workerPool(noWorkers);
+    bool success = true;
+    for (int run{ 0 }; run < 3; ++run) {
+        Queue<double> inputQueue, outputQueue;
+        auto sink{ outputQueue.subscribe() };
+        auto pool(makeExecutionPool(inputQueue, outputQueue, noWorkers, workerPool));
+        pool->setMode(ExecutionMode::Inline);
+        Latch latch(2);
+        std::thread poolThr([&]() { (*pool)(latch, AddOffset{}, 1.); });
+        std::thread sourceThr(produce, std::ref(inputQueue), noMessages);
+        latch.wait();
+        int received{ 0 };
+        while (auto val{ sink.pop() })
+            success &= val.value() == ++received;
+        sourceThr.join();
+        poolThr.join();
+        std::cout << "run " << run << ": " << received << " results\n";
+        success &= received == noMessages;
+    }
+    // the runs need no thread but the workers
+    success &= workerPool.size() <= noWorkers + 1;
+    return success;
+}
+
+int test3() {
+    // THIRD TEST
+    // An unordered execution pool, whose first message is much slower than the others
+    // OUTPUT: all the results are published, the first one last
+
+    std::cout << "\n ---------------- Third Test ---------------- \n";
+    std::cout << "OUTPUT:  100 results, 0 published after the other 99\n\n";
+
+    const int noMessages{ 100 };
+    Queue<double> inputQueue, outputQueue;
+    auto sink{ outputQueue.subscribe() };
+    auto pool(makeExecutionPool(inputQueue, outputQueue, 4));
+    pool->setMode(ExecutionMode::Unordered);
+    std::thread poolThr(std::ref(*pool), SlowFirst{});
+    std::thread sourceThr(produce, std::ref(inputQueue), noMessages);
+    std::vector<double> received;
+    while (auto val{ sink.pop() })
+        received.push_back(val.value());
+    sourceThr.join();
+    poolThr.join();
+
+    std::cout << received.size() << " results, the last is " << received.back() << std::endl;
+    bool success = received.size() == noMessages && received.back() == 0.;
+    std::sort(received.begin(), received.end());
+    for (int i{ 0 }; success && i < noMessages; ++i)
+        success &= received[i] == i;
+    return success;
+}
+
+int test4() {
+    // FOURTH TEST
+    // An inline run on a thread that is itself subscribed to the input queue
+    // OUTPUT: the run does not replace the thread subscription, which still reads every message
+
+    std::cout << "\n ---------------- Fourth Test ---------------- \n";
+    std::cout << "OUTPUT:  100 results, and 100 messages read by the pool thread\n\n";
+
+    const int noMessages{ 100 };
+    Queue<double> inputQueue, outputQueue;
+    auto sink{ outputQueue.subscribe() };
+    auto pool(makeExecutionPool(inputQueue, outputQueue, 2));
+    pool->setMode(ExecutionMode::Inline);
+    int read{ 0 };
+    std::thread poolThr([&]() {
+        inputQueue.subscribe();
+        (*pool)(AddOffset{}, 0.5);
+        while (inputQueue.pop())
+            ++read;
+        inputQueue.unsubscribe();
+    });
+    std::thread sourceThr(produce, std::ref(inputQueue), noMessages);
+    int received{ 0 };
+    while (sink.pop())
+        ++received;
+    sourceThr.join();
+    poolThr.join();
+
+    std::cout << received << " results, " << read << " messages read by the pool thread\n";
+    return received == noMessages && read == noMessages;
+}
+
+int test5() {
+    // FIFTH TEST
+    // Dispatched runs of the same pool, one after the other on the same queues
+    // OUTPUT: each run publishes all its results in order, its indices starting again from 0
+
+    std::cout << "\n ---------------- Fifth Test ---------------- \n";
+    std::cout << "OUTPUT:  3 dispatched runs of 2000 messages, all in order\n\n";
+
+    // more messages than the jobs queues hold, so that each run wraps around them
+    const int noMessages{ 2000 };
+    Queue<double> inputQueue, outputQueue;
+    auto pool(makeExecutionPool(inputQueue, outputQueue, 3));
+    bool success = true;
+    for (int run{ 0 }; run < 3; ++run) {
+        auto sink{ outputQueue.subscribe() };
+        std::thread poolThr(std::ref(*pool), AddOffset{}, 0.5);
+        std::thread sourceThr(produce, std::ref(inputQueue), noMessages);
+        int received{ 0 };
+        while (auto val{ sink.pop() })
+            success &= val.value() == received++ + 0.5;
+        sourceThr.join();
+        poolThr.join();
+        sink.unsubscribe();
+        std::cout << "run " << run << ": " << received << " results\n";
+        success &= received == noMessages;
+    }
+    return success;
+}
+
+int main() {
+    if (!test1()) {
+        std::cout << "Test1 failed\n";
+        return 1;
+    }
+    if (!test2()) {
+        std::cout << "Test2 failed\n";
+        return 1;
+    }
+    if (!test3()) {
+        std::cout << "Test3 failed\n";
+        return 1;
+    }
+    if (!test4()) {
+        std::cout << "Test4 failed\n";
+        return 1;
+    }
+    if (!test5()) {
+        std::cout << "Test5 failed\n";
+        return 1;
+    }
+    return 0;
+}
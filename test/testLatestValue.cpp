@@ -0,0 +1,86 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/LatestValue.h"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+using namespace rtb::Concurrency;
+
+int test1() {
+    // FIRST TEST
+    // The producer pushes much faster than the consumer reads
+    // OUTPUT: the consumer reads increasing values, always ending with the last one pushed
+
+    std::cout << "\n ---------------- First Test ---------------- \n";
+    std::cout << "OUTPUT:  consumer skips stale values and reads the last one\n\n";
+
+    const int noMessages{ 100000 };
+    LatestValue<std::vector<int>> channel;
+    std::vector<int> consumed;
+    std::thread consThr([&]() {
+        while (auto val{ channel.pop() }) {
+            // the three elements of a value are always written together
+            if (val->at(0) != val->at(1) || val->at(1) != val->at(2)) return;
+            consumed.push_back(val->at(0));
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+    for (int i{ 1 }; i <= noMessages; ++i)
+        channel.push(std::vector<int>(3, i));
+    channel.close();
+    consThr.join();
+
+    bool success = !consumed.empty() && consumed.back() == noMessages;
+    for (size_t i{ 1 }; i < consumed.size(); ++i)
+        success &= consumed[i] > consumed[i - 1];
+    return success;
+}
+
+int test2() {
+    // SECOND TEST
+    // Non-blocking reads before and after the producer writes and closes
+    // OUTPUT: Timeout, then the latest value, then Closed
+
+    std::cout << "\n ---------------- Second Test ---------------- \n";
+    std::cout << "OUTPUT:  tryPop reports Timeout, Ok and Closed\n\n";
+
+    LatestValue<int> channel;
+    int value{ 0 };
+    bool success = channel.tryPop(value) == PopResult::Timeout;
+    channel.push(1);
+    channel.push(2);
+    success &= (channel.tryPop(value) == PopResult::Ok) && (value == 2);
+    success &= channel.popFor(value, std::chrono::milliseconds(10)) == PopResult::Timeout;
+    channel.push(3);
+    channel.close();
+    success &= (channel.tryPop(value) == PopResult::Ok) && (value == 3);
+    success &= channel.tryPop(value) == PopResult::Closed;
+    success &= !channel.pop().has_value();
+    return success;
+}
+
+int main() {
+    if (!test1()) {
+        std::cout << "Test1 failed\n";
+        return 1;
+    }
+    if (!test2()) {
+        std::cout << "Test2 failed\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/Queue.h"
+#include "rtb/concurrency/SimpleQueue.h"
+#include "rtb/concurrency/ThreadPool.h"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <functional>
+
+using namespace rtb::Concurrency;
+
+struct AddOne {
+    using InputData = double;
+    using OutputData = double;
+    double operator()(double value) { return value + 1.; }
+};
+
+int test1() {
+    // FIRST TEST
+    // Two subscribers read all and part of the messages of a queue, then one waits in vain
+    // OUTPUT: counters, depth, high-water mark and lag match what has been pushed and read
+
+    std::cout << "\n ---------------- First Test ---------------- \n";
+    std::cout << "OUTPUT:  Queue and SimpleQueue counters match the traffic\n\n";
+
+    Queue<int> q;
+    auto fast{ q.subscribe() };
+    auto slow{ q.subscribe() };
+    std::vector<int> values{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    q.pushRange(values.begin(), values.end());
+    std::vector<int> read;
+    fast.popBatch(std::back_inserter(read), 10);
+    for (int i{ 0 }; i < 4; ++i)
+        slow.pop();
+    int value{ 0 };
+    fast.popFor(value, std::chrono::milliseconds(5));
+
+    auto queueMetrics{ q.metrics() };
+    auto fastMetrics{ fast.metrics() };
+    auto slowMetrics{ slow.metrics() };
+    bool success = queueMetrics.pushed == 10 && queueMetrics.popped == 14;
+    success &= queueMetrics.depth == 6 && queueMetrics.highWaterMark == 10;
+    success &= queueMetrics.popBlocked >= std::chrono::milliseconds(5);
+    success &= fastMetrics.popped == 10 && fastMetrics.lag == 0;
+    success &= fastMetrics.popBlocked >= std::chrono::milliseconds(5);
+    success &= slowMetrics.popped == 4 && slowMetrics.lag == 6;
+    success &= slowMetrics.popBlocked == std::chrono::nanoseconds(0);
+
+    SimpleQueue<int> simple;
+    simple.pushRange(values.begin(), values.end());
+    for (int i{ 0 }; i < 3; ++i)
+        simple.pop();
+    auto simpleMetrics{ simple.metrics() };
+    success &= simpleMetrics.pushed == 10 && simpleMetrics.popped == 3;
+    success &= simpleMetrics.depth == 7 && simpleMetrics.highWaterMark == 10;
+    return success;
+}
+
+int test2() {
+    // SECOND TEST
+    // An execution pool processes a stream of messages, in each mode
+    // OUTPUT: every message is dispatched, processed and published once
+
+    std::cout << "\n ---------------- Second Test ---------------- \n";
+    std::cout << "OUTPUT:  ExecutionPool counters match the number of messages, in all the modes\n\n";
+
+    const int noMessages{ 100 };
+    bool success = true;
+    for (auto mode :
+        { ExecutionMode::Dispatched, ExecutionMode::Inline, ExecutionMode::Unordered }) {
+        Queue<double> inputQueue, outputQueue;
+        auto sink{ outputQueue.subscribe() };
+        auto pool(makeExecutionPool(inputQueue, outputQueue, 3));
+        pool->setMode(mode);
+        std::thread poolThr(std::ref(*pool), AddOne{});
+        std::thread sourceThr([&]() {
+            // leaves time to the pool to subscribe to its input
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            for (int i{ 0 }; i < noMessages; ++i)
+                inputQueue.push(i);
+            inputQueue.close();
+        });
+        int received{ 0 };
+        while (sink.pop())
+            ++received;
+        sourceThr.join();
+        poolThr.join();
+
+        auto metrics{ pool->metrics() };
+        success &= received == noMessages;
+        success &= metrics.dispatched == noMessages;
+        success &= metrics.processed == noMessages;
+        success &= metrics.published == noMessages;
+    }
+    return success;
+}
+
+int main() {
+    if (!test1()) {
+        std::cout << "Test1 failed\n";
+        return 1;
+    }
+    if (!test2()) {
+        std::cout << "Test2 failed\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/MpmcQueue.h"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+
+using namespace rtb::Concurrency;
+using std::ref;
+
+int test1() {
+    // FIRST TEST
+    // Four producers and four consumers share a queue of 16 messages
+    // OUTPUT: every message is read exactly once, and the consumers stop at the end of stream
+
+    std::cout << "\n ---------------- First Test ---------------- \n";
+    std::cout << "OUTPUT:  4 producers and 4 consumers exchange 40000 messages\n\n";
+
+    const int noProducers{ 4 };
+    const int noConsumers{ 4 };
+    const int noMessages{ 10000 };
+    MpmcQueue<int> q(16);
+    std::vector<std::vector<int>> consumed(noConsumers);
+
+    std::vector<std::thread> consThrs;
+    for (auto &it : consumed) {
+        consThrs.emplace_back([&q](std::vector<int> &read) {
+            while (auto val{ q.pop() })
+                read.push_back(val.value());
+        }, ref(it));
+    }
+    std::vector<std::thread> prodThrs;
+    for (int p{ 0 }; p < noProducers; ++p) {
+        prodThrs.emplace_back([&q, p]() {
+            for (int i{ 0 }; i < noMessages; ++i)
+                q.push(p * noMessages + i);
+        });
+    }
+    for (auto &it : prodThrs)
+        it.join();
+    for (int i{ 0 }; i < noConsumers; ++i)
+        q.close();
+    for (auto &it : consThrs)
+        it.join();
+
+    std::vector<int> all;
+    bool success = true;
+    for (auto &it : consumed) {
+        // the messages of each producer are read in the order they were pushed
+        std::vector<int> last(noProducers, -1);
+        for (auto val : it) {
+            success &= val > last[val / noMessages];
+            last[val / noMessages] = val;
+        }
+        all.insert(all.end(), it.begin(), it.end());
+    }
+    std::sort(all.begin(), all.end());
+    success &= all.size() == noProducers * noMessages;
+    for (int i{ 0 }; success && i < noProducers * noMessages; ++i)
+        success &= all[i] == i;
+    return success;
+}
+
+int test2() {
+    // SECOND TEST
+    // Non-blocking and timed calls on an empty, a full and a closed queue
+    // OUTPUT: Timeout when empty, false when full, Closed after close
+
+    std::cout << "\n ---------------- Second Test ---------------- \n";
+    std::cout << "OUTPUT:  timeouts, full queue and end of stream are reported\n\n";
+
+    MpmcQueue<int> q(3);
+    int item{ 0 };
+    bool success = q.capacity() == 4;
+    success &= q.tryPop(item) == PopResult::Timeout;
+    success &= q.popFor(item, std::chrono::milliseconds(10)) == PopResult::Timeout;
+    for (int i{ 0 }; i < 4; ++i)
+        success &= q.tryPush(i);
+    success &= !q.tryPush(4) && q.size() == 4;
+    success &= q.tryPop(item) == PopResult::Ok && item == 0;
+    q.close();
+    for (int i{ 1 }; i < 4; ++i)
+        success &= q.popFor(item, std::chrono::milliseconds(10)) == PopResult::Ok && item == i;
+    success &= q.tryPop(item) == PopResult::Closed;
+    return success;
+}
+
+int main() {
+    if (!test1()) {
+        std::cout << "Test1 failed\n";
+        return 1;
+    }
+    if (!test2()) {
+        std::cout << "Test2 failed\n";
+        return 1;
+    }
+    return 0;
+}
@@ -13,9 +13,16 @@
  * limitations under the License.                                             *
  * -------------------------------------------------------------------------- */
 #include "threadFunctions.h"
+#include "rtb/concurrency/SharedQueue.h"
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <thread>
 #include <vector>
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
 
 using namespace rtb::Concurrency;
 using std::ref;
@@ -318,6 +325,329 @@ int test5() {
     return success;
 }
 
+int test6() {
+    // SIXTH TEST
+    // One thread owns two subscriptions and hands one of them over to another thread
+    // OUTPUT: both subscriptions read all the messages
+
+    std::cout << "\n ---------------- Sixth Test ---------------- \n";
+    std::cout << " OUTPUT: subscriptions are not tied to the subscribing thread\n\n";
+
+    Queue<int> q;
+    auto first{ q.subscribe() };
+    auto second{ q.subscribe() };
+
+    std::vector<int> producedValues, firstValues, secondValues;
+    for (int i{ 1 }; i <= 100; ++i) {
+        q.push(i);
+        producedValues.push_back(i);
+    }
+    q.close();
+
+    bool success = (first.messagesToRead() == 101) && (second.messagesToRead() == 101);
+    std::thread consumerThr([&]() {
+        while (auto val{ second.pop() })
+            secondValues.push_back(val.value());
+        second.unsubscribe();
+    });
+    while (auto val{ first.pop() })
+        firstValues.push_back(val.value());
+    first.unsubscribe();
+    consumerThr.join();
+
+    success &= (firstValues == producedValues) && (secondValues == producedValues);
+    success &= !first.isSubscribed() && !second.isSubscribed();
+    return success;
+}
+
+int test7() {
+    // SEVENTH TEST
+    // Two subscribers read a large message from a SharedQueue
+    // OUTPUT: both get the same payload, which is released after both dropped it
+
+    std::cout << "\n ---------------- Seventh Test ---------------- \n";
+    std::cout << " OUTPUT: subscribers share a single copy of the message\n\n";
+
+    SharedQueue<std::vector<double>> q;
+    auto first{ q.subscribe() };
+    auto second{ q.subscribe() };
+    q.push(std::vector<double>(500, 1.));
+
+    auto firstFrame{ first.pop().value() };
+    bool success = firstFrame.use_count() == 2;
+    auto secondFrame{ second.pop().value() };
+    // the queue has dropped its reference when the last subscriber read the message
+    success &= (firstFrame == secondFrame) && (firstFrame.use_count() == 2);
+    std::weak_ptr<const std::vector<double>> frame{ firstFrame };
+    firstFrame.reset();
+    secondFrame.reset();
+    success &= frame.expired();
+    first.unsubscribe();
+    second.unsubscribe();
+    return success;
+}
+
+int test8() {
+    // EIGHTH TEST
+    // The producer pushes the messages in batches, the consumer reads them in batches
+    // OUTPUT: the consumer reads all the messages, then the end of the stream
+
+    std::cout << "\n ---------------- Eighth Test ---------------- \n";
+    std::cout << " OUTPUT: batches of 16 messages are read in batches of 10\n\n";
+
+    Queue<int> q;
+    auto subscription{ q.subscribe() };
+    std::vector<int> producedValues(16), consumedValues;
+    for (int i{ 0 }; i < 16; ++i)
+        producedValues[i] = i;
+
+    std::thread prodThr([&]() {
+        for (int i{ 0 }; i < 4; ++i)
+            q.pushRange(producedValues.begin(), producedValues.end());
+        q.close();
+    });
+    size_t read{ 0 };
+    bool success = true;
+    while ((read = subscription.popBatch(std::back_inserter(consumedValues), 10)) > 0)
+        success &= (read <= 10);
+    prodThr.join();
+    subscription.unsubscribe();
+
+    success &= (consumedValues.size() == 64);
+    for (size_t i{ 0 }; i < consumedValues.size(); ++i)
+        success &= (consumedValues[i] == producedValues[i % 16]);
+    return success;
+}
+
+std::vector<int> readAll(Queue<int>::Subscription &subscription) {
+    std::vector<int> values;
+    while (auto val{ subscription.pop() })
+        values.push_back(val.value());
+    return values;
+}
+
+int test9() {
+    // NINTH TEST
+    // Ten messages are pushed in a queue bounded to 4, while the subscribers are not reading
+    // OUTPUT: each subscriber loses the messages its overflow policy says
+
+    std::cout << "\n ---------------- Ninth Test ---------------- \n";
+    std::cout << " OUTPUT: bounded queue applies the overflow policies\n\n";
+
+    Queue<int> dropNewestQueue(4, OverflowPolicy::DropNewest);
+    auto dropNewest{ dropNewestQueue.subscribe() };
+    Queue<int> q(4, OverflowPolicy::DropOldest);
+    auto dropOldest{ q.subscribe() };
+    auto skipToLatest{ q.subscribe(OverflowPolicy::SkipToLatest) };
+    for (int i{ 1 }; i <= 10; ++i) {
+        dropNewestQueue.push(i);
+        q.push(i);
+    }
+    dropNewestQueue.close();
+    q.close();
+
+    bool success = readAll(dropNewest) == std::vector<int>({ 1, 2, 3, 4 });
+    success &= readAll(dropOldest) == std::vector<int>({ 8, 9, 10 });
+    // skips at 5 and at 9, then the close drops the oldest message of `dropOldest` only
+    success &= readAll(skipToLatest) == std::vector<int>({ 9, 10 });
+    dropNewest.unsubscribe();
+    dropOldest.unsubscribe();
+    skipToLatest.unsubscribe();
+
+    // a blocking queue never loses a message
+    Queue<int> blockingQueue(4);
+    auto blocking{ blockingQueue.subscribe() };
+    std::thread prodThr([&]() {
+        for (int i{ 1 }; i <= 100; ++i)
+            blockingQueue.push(i);
+        blockingQueue.close();
+    });
+    std::vector<int> values;
+    while (auto val{ blocking.pop() }) {
+        success &= (blocking.messagesToRead() <= 4);
+        values.push_back(val.value());
+    }
+    prodThr.join();
+    blocking.unsubscribe();
+    success &= values.size() == 100;
+    return success;
+}
+
+int test10() {
+    // TENTH TEST
+    // Non-blocking and timed pops on an empty, a filled and a closed queue
+    // OUTPUT: timeouts are reported distinctly from the end of the stream
+
+    std::cout << "\n ---------------- Tenth Test ---------------- \n";
+    std::cout << " OUTPUT: tryPop and popFor report Timeout, Ok and Closed\n\n";
+
+    Queue<int> q;
+    auto subscription{ q.subscribe() };
+    int value{ 0 };
+    bool success = subscription.tryPop(value) == PopResult::Timeout;
+    auto start{ std::chrono::steady_clock::now() };
+    success &= subscription.popFor(value, TimeT{ 20 }) == PopResult::Timeout;
+    success &= (std::chrono::steady_clock::now() - start) >= TimeT{ 20 };
+
+    std::thread prodThr([&]() {
+        std::this_thread::sleep_for(TimeT{ 10 });
+        q.push(42);
+        q.close();
+    });
+    success &= subscription.popFor(value, TimeT{ 5000 }) == PopResult::Ok;
+    success &= (value == 42);
+    prodThr.join();
+    success &= q.tryPop(value) == PopResult::Closed;
+    q.unsubscribe();
+    return success;
+}
+
+// counts the copies of the messages going through a queue
+struct Counted {
+    Counted() = default;
+    Counted(const Counted &) { ++copies; }
+    Counted(Counted &&) = default;
+    Counted &operator=(const Counted &) {
+        ++copies;
+        return *this;
+    }
+    Counted &operator=(Counted &&) = default;
+    static inline int copies{ 0 };
+};
+
+int test11() {
+    // ELEVENTH TEST
+    // Move-only messages with a single subscriber, and copyable messages counted while they
+    // go through a queue with two subscribers
+    // OUTPUT: unique_ptr messages are delivered, only the first reader of a message gets a copy
+
+    std::cout << "\n ---------------- Eleventh Test ---------------- \n";
+    std::cout << " OUTPUT: move-only messages are queued, the last reader takes the message\n\n";
+
+    Queue<std::unique_ptr<int>> q;
+    auto subscription{ q.subscribe() };
+    q.push(std::make_unique<int>(1));
+    q.emplace(new int{ 2 });
+    q.close();
+    bool success = true;
+    auto first{ subscription.pop() };
+    auto second{ subscription.pop() };
+    success &= first && *first.value() == 1;
+    success &= second && *second.value() == 2;
+    success &= !subscription.pop();
+    subscription.unsubscribe();
+
+    Queue<Counted> counted;
+    auto reader1{ counted.subscribe() };
+    auto reader2{ counted.subscribe() };
+    counted.emplace();
+    counted.push(Counted{});
+    for (int i{ 0 }; i < 2; ++i) {
+        reader1.pop();
+        reader2.pop();
+    }
+    success &= (Counted::copies == 2);
+    return success;
+}
+
+int test12() {
+    // TWELFTH TEST
+    // Three producers publish into the same queue, read by two subscribers
+    // OUTPUT: both subscribers read the same interleaving, which keeps the order of each
+    //         producer, and the stream ends after the last producer closes
+
+    std::cout << "\n ---------------- Twelfth Test ---------------- \n";
+    std::cout << " OUTPUT: subscribers see the same total order of all the producers\n\n";
+
+    const int noProducers{ 3 }, noMessages{ 1000 };
+    Queue<std::pair<int, int>> q;
+    q.setProducers(noProducers);
+    auto reader1{ q.subscribe() };
+    auto reader2{ q.subscribe() };
+
+    std::vector<std::thread> prodThrs;
+    for (int id{ 0 }; id < noProducers; ++id)
+        prodThrs.emplace_back([&q, id, noMessages]() {
+            for (int i{ 0 }; i < noMessages; ++i)
+                q.push({ id, i });
+            q.close();
+        });
+
+    std::vector<std::pair<int, int>> read1, read2;
+    std::thread consThr([&]() {
+        while (auto val{ reader2.pop() })
+            read2.push_back(val.value());
+    });
+    while (auto val{ reader1.pop() })
+        read1.push_back(val.value());
+    for (auto &it : prodThrs)
+        it.join();
+    consThr.join();
+
+    bool success = read1 == read2;
+    success &= read1.size() == noProducers * noMessages;
+    std::vector<int> next(noProducers, 0);
+    for (auto &it : read1)
+        success &= (it.second == next[it.first]++);
+    return success;
+}
+
+int test13() {
+    // THIRTEENTH TEST
+    // A subscription is moved onto another live subscription of a bounded, blocking queue
+    // OUTPUT: the overwritten subscriber is unsubscribed, so the producer never waits for it
+
+    std::cout << "\n ---------------- Thirteenth Test ---------------- \n";
+    std::cout << " OUTPUT: 100 messages through a queue of 2 after the move\n\n";
+
+    const int noMessages{ 100 };
+    Queue<int> q(2, OverflowPolicy::Block);
+    auto reader{ q.subscribe() };
+    auto other{ q.subscribe() };
+    reader = std::move(other);
+    bool success = reader.isSubscribed() && !other.isSubscribed();
+
+    std::thread prodThr([&q, noMessages]() {
+        for (int i{ 0 }; i < noMessages; ++i)
+            q.push(i);
+        q.close();
+    });
+    int read{ 0 };
+    while (auto val{ reader.pop() })
+        success &= val.value() == read++;
+    prodThr.join();
+    success &= read == noMessages;
+    return success;
+}
+
+int test14() {
+    // FOURTEENTH TEST
+    // A producer waits for the only blocking subscriber of a full queue, which unsubscribes
+    // while a dropping subscriber is still at the front
+    // OUTPUT: the producer is released, and the dropping subscriber loses its oldest message
+
+    std::cout << "\n ---------------- Fourteenth Test ---------------- \n";
+    std::cout << " OUTPUT: the remaining policies apply when the blocking subscriber leaves\n\n";
+
+    Queue<int> q(2, OverflowPolicy::DropOldest);
+    auto blocking{ q.subscribe(OverflowPolicy::Block) };
+    auto dropOldest{ q.subscribe() };
+    q.push(1);
+    q.push(2);
+    std::atomic<bool> pushed{ false };
+    std::thread prodThr([&]() {
+        q.push(3);
+        pushed = true;
+        q.close();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    bool success = !pushed;
+    blocking.unsubscribe();
+    prodThr.join();
+    success &= readAll(dropOldest) == std::vector<int>({ 3 });
+    return success;
+}
+
 int main() {
     if (!test1()) {
         std::cout << "Test1 failed\n";
@@ -339,6 +669,42 @@ int main() {
         std::cout << "Test5 failed\n";
         return 1;
     }
+    if (!test6()) {
+        std::cout << "Test6 failed\n";
+        return 1;
+    }
+    if (!test7()) {
+        std::cout << "Test7 failed\n";
+        return 1;
+    }
+    if (!test8()) {
+        std::cout << "Test8 failed\n";
+        return 1;
+    }
+    if (!test9()) {
+        std::cout << "Test9 failed\n";
+        return 1;
+    }
+    if (!test10()) {
+        std::cout << "Test10 failed\n";
+        return 1;
+    }
+    if (!test11()) {
+        std::cout << "Test11 failed\n";
+        return 1;
+    }
+    if (!test12()) {
+        std::cout << "Test12 failed\n";
+        return 1;
+    }
+    if (!test13()) {
+        std::cout << "Test13 failed\n";
+        return 1;
+    }
+    if (!test14()) {
+        std::cout << "Test14 failed\n";
+        return 1;
+    }
 
     return 0;
 }
@@ -0,0 +1,239 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/Recording.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+
+using namespace rtb::Concurrency;
+
+struct Frame {
+    int index;
+    double values[4];
+};
+
+// variable size messages need their own serializer
+struct StringSerializer {
+    static std::size_t size(const std::string &item) { return item.size(); }
+    static void write(const std::string &item, unsigned char *out) {
+        std::memcpy(out, item.data(), item.size());
+    }
+    static std::string read(const unsigned char *in, std::size_t size) {
+        return std::string(reinterpret_cast<const char *>(in), size);
+    }
+};
+
+template<typename T>
+std::vector<T> readAll(typename Queue<T>::Subscription &subscription) {
+    std::vector<T> read;
+    while (auto val{ subscription.pop() })
+        read.push_back(val.value());
+    return read;
+}
+
+int test1() {
+    // FIRST TEST
+    // A stream of frames is recorded, through a file that has to grow, then replayed
+    // OUTPUT: the replayed frames are the recorded ones
+
+    std::cout << "\n ---------------- First Test ---------------- \n";
+    std::cout << "OUTPUT:  5000 frames are recorded and replayed as fast as possible\n\n";
+
+    const char *path{ "testRecording1.rec" };
+    const int noMessages{ 5000 };
+    {
+        Queue<Frame> live;
+        Recorder<Frame> recorder(live, path, 4096);
+        std::thread recorderThr(std::ref(recorder));
+        for (int i{ 0 }; i < noMessages; ++i)
+            live.push(Frame{ i, { i * 1., i * 2., i * 3., i * 4. } });
+        live.close();
+        recorderThr.join();
+        if (recorder.frames() != noMessages) return false;
+    }
+
+    Replayer<Frame> replayer(path);
+    Queue<Frame> replayed;
+    auto subscription{ replayed.subscribe() };
+    std::thread replayThr([&]() { replayer.replay(replayed); });
+    auto frames{ readAll<Frame>(subscription) };
+    replayThr.join();
+    std::remove(path);
+
+    bool success = replayer.frames() == noMessages && frames.size() == noMessages;
+    for (int i{ 0 }; i < static_cast<int>(frames.size()); ++i)
+        success &= frames[i].index == i && frames[i].values[3] == i * 4.;
+    return success;
+}
+
+int test2() {
+    // SECOND TEST
+    // Strings pushed 20 ms apart are recorded with a custom serializer, then replayed with
+    // the original timing
+    // OUTPUT: the strings are replayed in order, and the replay lasts as long as the stream
+
+    std::cout << "\n ---------------- Second Test ---------------- \n";
+    std::cout << "OUTPUT:  variable size messages are replayed at the original timing\n\n";
+
+    const char *path{ "testRecording2.rec" };
+    const std::vector<std::string> messages{ "marker", "", "force plate", "emg" };
+    {
+        Queue<std::string> live;
+        Recorder<std::string, StringSerializer> recorder(live, path);
+        std::thread recorderThr(std::ref(recorder));
+        for (auto &it : messages) {
+            live.push(it);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        live.close();
+        recorderThr.join();
+    }
+
+    Replayer<std::string, StringSerializer> replayer(path);
+    Queue<std::string> replayed;
+    auto subscription{ replayed.subscribe() };
+    const auto start{ std::chrono::steady_clock::now() };
+    std::thread replayThr([&]() { replayer.replay(replayed, ReplayTiming::Original); });
+    auto read{ readAll<std::string>(subscription) };
+    replayThr.join();
+    const auto elapsed{ std::chrono::steady_clock::now() - start };
+
+    bool success = read == messages;
+    success &= elapsed >= std::chrono::milliseconds(55);
+    try {
+        Replayer<Frame> wrongType(path);
+        success = false;
+    } catch (const std::runtime_error &) {
+    }
+    std::remove(path);
+    return success;
+}
+
+// overwrites `size` bytes of the file at `offset`
+void patch(const char *path, long offset, const void *data, std::size_t size) {
+    std::FILE *file{ std::fopen(path, "r+b") };
+    std::fseek(file, offset, SEEK_SET);
+    std::fwrite(data, 1, size, file);
+    std::fclose(file);
+}
+
+template<typename T, typename Serializer = RawSerializer<T>>
+bool isRejected(const char *path) {
+    try {
+        Replayer<T, Serializer> replayer(path);
+    } catch (const std::runtime_error &) {
+        return true;
+    }
+    return false;
+}
+
+int test3() {
+    // THIRD TEST
+    // Recordings with more frames than bytes, and with a frame larger than the file
+    // OUTPUT: the replayer throws instead of reading past the mapping
+
+    std::cout << "\n ---------------- Third Test ---------------- \n";
+    std::cout << "OUTPUT:  truncated and corrupted recordings are rejected\n\n";
+
+    const char *path{ "testRecording3.rec" };
+    const int noMessages{ 10 };
+    {
+        Queue<Frame> live;
+        Recorder<Frame> recorder(live, path, 4096);
+        std::thread recorderThr(std::ref(recorder));
+        for (int i{ 0 }; i < noMessages; ++i)
+            live.push(Frame{ i, { 0., 0., 0., 0. } });
+        live.close();
+        recorderThr.join();
+    }
+    bool success = !isRejected<Frame>(path);
+
+    const std::uint64_t moreFrames{ noMessages + 1 };
+    patch(path, offsetof(RecordingHeader, frames), &moreFrames, sizeof(moreFrames));
+    success &= isRejected<Frame>(path);
+    const std::uint64_t frames{ noMessages };
+    patch(path, offsetof(RecordingHeader, frames), &frames, sizeof(frames));
+    success &= !isRejected<Frame>(path);
+
+    const std::uint64_t hugeSize{ std::uint64_t{ 1 } << 40 };
+    patch(path,
+        sizeof(RecordingHeader) + offsetof(RecordedFrameHeader, size),
+        &hugeSize,
+        sizeof(hugeSize));
+    success &= isRejected<Frame>(path);
+    std::remove(path);
+    return success;
+}
+
+int test4() {
+    // FOURTH TEST
+    // A recorder constructed by a thread that is itself subscribed to the recorded queue
+    // OUTPUT: both the thread and the recorder read all the messages
+
+    std::cout << "\n ---------------- Fourth Test ---------------- \n";
+    std::cout << "OUTPUT:  100 frames read by the consumer thread, and 100 recorded\n\n";
+
+    const char *path{ "testRecording4.rec" };
+    const int noMessages{ 100 };
+    Queue<Frame> live;
+    live.subscribe();
+    int read{ 0 };
+    std::uint64_t recorded{ 0 };
+    {
+        Recorder<Frame> recorder(live, path);
+        std::thread recorderThr(std::ref(recorder));
+        std::thread prodThr([&]() {
+            for (int i{ 0 }; i < noMessages; ++i)
+                live.push(Frame{ i, { i * 1., i * 2., i * 3., i * 4. } });
+            live.close();
+        });
+        while (auto val{ live.pop() })
+            read += val.value().index == read;
+        live.unsubscribe();
+        prodThr.join();
+        recorderThr.join();
+        recorded = recorder.frames();
+    }
+    std::remove(path);
+
+    std::cout << read << " frames read, " << recorded << " recorded\n";
+    return read == noMessages && recorded == noMessages;
+}
+
+int main() {
+    if (!test1()) {
+        std::cout << "Test1 failed\n";
+        return 1;
+    }
+    if (!test2()) {
+        std::cout << "Test2 failed\n";
+        return 1;
+    }
+    if (!test3()) {
+        std::cout << "Test3 failed\n";
+        return 1;
+    }
+    if (!test4()) {
+        std::cout << "Test4 failed\n";
+        return 1;
+    }
+    return 0;
+}
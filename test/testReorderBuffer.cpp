@@ -0,0 +1,89 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/ReorderBuffer.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rtb::Concurrency;
+
+int test1() {
+    // FIRST TEST
+    // Four workers push shuffled indices through a buffer of 8 slots
+    // OUTPUT: the consumer pops all the results in index order
+
+    std::cout << "\n ---------------- First Test ---------------- \n";
+    std::cout << "OUTPUT:  20000 results pushed out of order are popped in order\n\n";
+
+    const unsigned noWorkers{ 4 };
+    const IndexT noResults{ 20000 };
+    ReorderBuffer<IndexT> buffer(8);
+    std::vector<std::thread> workers;
+    for (unsigned w{ 0 }; w < noWorkers; ++w) {
+        workers.emplace_back([&buffer, w]() {
+            // each worker takes the indices w, w + noWorkers, ... and swaps neighbours
+            std::vector<IndexT> indices;
+            for (IndexT i{ w }; i < noResults; i += noWorkers)
+                indices.push_back(i);
+            for (std::size_t i{ 0 }; i + 1 < indices.size(); i += 2)
+                std::swap(indices[i], indices[i + 1]);
+            for (auto idx : indices)
+                buffer.push(idx, idx * 2);
+        });
+    }
+    bool success = true;
+    for (IndexT i{ 0 }; i < noResults; ++i)
+        success &= buffer.pop() == i * 2;
+    for (auto &it : workers)
+        it.join();
+    success &= buffer.next() == noResults;
+    return success;
+}
+
+int test2() {
+    // SECOND TEST
+    // Results that are not indexed doubles, pushed in reverse order within the capacity
+    // OUTPUT: strings are moved out in index order
+
+    std::cout << "\n ---------------- Second Test ---------------- \n";
+    std::cout << "OUTPUT:  \"0\" \"1\" \"2\" \"3\"\n\n";
+
+    ReorderBuffer<std::string> buffer(3);
+    bool success = buffer.capacity() == 4;
+    for (IndexT idx{ 4 }; idx > 0; --idx)
+        buffer.push(idx - 1, std::to_string(idx - 1));
+    for (IndexT idx{ 0 }; idx < 4; ++idx) {
+        auto val{ buffer.pop() };
+        std::cout << "\"" << val << "\" ";
+        success &= val == std::to_string(idx);
+    }
+    std::cout << std::endl;
+    return success;
+}
+
+int main() {
+    if (!test1()) {
+        std::cout << "Test1 failed\n";
+        return 1;
+    }
+    if (!test2()) {
+        std::cout << "Test2 failed\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/RingBuffer.h"
+#include "rtb/concurrency/Queue.h"
+#include "rtb/concurrency/SimpleQueue.h"
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace rtb::Concurrency;
+
+int test1() {
+    // FIRST TEST
+    // Elements are pushed and popped so that the buffer wraps around and grows while wrapped
+    // OUTPUT: the elements come out in order and the capacity is a power of two
+
+    std::cout << "\n ---------------- First Test ---------------- \n";
+    std::cout << "OUTPUT:  FIFO order is kept across wrap-arounds and growth\n\n";
+
+    RingBuffer<std::string> buffer;
+    bool success = buffer.empty();
+    int pushed{ 0 }, popped{ 0 };
+    for (int round{ 0 }; round < 10; ++round) {
+        for (int i{ 0 }; i < 7 * (round + 1); ++i)
+            buffer.push_back(std::to_string(pushed++));
+        for (int i{ 0 }; i < 5 * (round + 1); ++i) {
+            success &= buffer.front() == std::to_string(popped++);
+            buffer.pop_front();
+        }
+    }
+    success &= buffer.size() == static_cast<size_t>(pushed - popped);
+    success &= buffer.back() == std::to_string(pushed - 1);
+    for (size_t i{ 0 }; i < buffer.size(); ++i)
+        success &= buffer[i] == std::to_string(popped + static_cast<int>(i));
+    success &= (buffer.capacity() & (buffer.capacity() - 1)) == 0;
+
+    // an element of the buffer can be pushed again, even when the buffer has to grow
+    RingBuffer<std::unique_ptr<int>> owners;
+    owners.emplace_back(std::make_unique<int>(1));
+    while (owners.size() < owners.capacity())
+        owners.emplace_back(std::make_unique<int>(2));
+    owners.emplace_back(std::move(owners.front()));
+    success &= owners.size() == 17 && *owners.back() == 1;
+    return success;
+}
+
+int test2() {
+    // SECOND TEST
+    // Storage reserved up front, for the buffer and for the queues built on it
+    // OUTPUT: no growth while the backlog stays within the reserved size
+
+    std::cout << "\n ---------------- Second Test ---------------- \n";
+    std::cout << "OUTPUT:  reserved buffers do not grow at steady state\n\n";
+
+    RingBuffer<int> buffer(100);
+    bool success = buffer.capacity() == 128;
+    for (int i{ 0 }; i < 10000; ++i) {
+        buffer.push_back(i);
+        if (buffer.size() > 100) buffer.pop_front();
+    }
+    success &= buffer.capacity() == 128 && buffer.front() == 9900;
+
+    Queue<int> q;
+    q.reserve(256);
+    auto subscription{ q.subscribe() };
+    for (int i{ 0 }; i < 300; ++i)
+        q.push(i);
+    for (int i{ 0 }; i < 300; ++i)
+        success &= subscription.pop().value() == i;
+
+    SimpleQueue<int> simple;
+    simple.reserve(64);
+    simple.push(1);
+    success &= simple.pop().value() == 1;
+
+    SortedIndexedDataQueue<double> sorted;
+    sorted.reserve(64);
+    sorted.push(IndexedData<double>{ 1, 1.5 });
+    sorted.push(IndexedData<double>{ 0, 0.5 });
+    success &= std::get<1>(sorted.popIndex(0).value()) == 0.5;
+    return success;
+}
+
+int main() {
+    if (!test1()) {
+        std::cout << "Test1 failed\n";
+        return 1;
+    }
+    if (!test2()) {
+        std::cout << "Test2 failed\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/RingQueue.h"
+#include "rtb/concurrency/Latch.h"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <functional>
+
+using namespace rtb::Concurrency;
+using std::ref;
+
+void produce(RingQueue<int> &q, Latch &latch, int noMessages) {
+    latch.wait();
+    for (int i{ 1 }; i <= noMessages; ++i)
+        q.push(i);
+    q.close();
+}
+
+void consume(RingQueue<int> &q, Latch &latch, std::vector<int> &consumed) {
+    q.subscribe();
+    latch.wait();
+    while (auto val{ q.pop() })
+        consumed.push_back(val.value());
+    q.unsubscribe();
+}
+
+int test1() {
+    // FIRST TEST
+    // The producer sends many more messages than the capacity of the ring.
+    // OUTPUT: all the consumers read all the messages, in order
+
+    std::cout << "\n ---------------- First Test ---------------- \n";
+    std::cout << "OUTPUT:  all the consumers read 10000 messages through a ring of 16\n\n";
+
+    const int noMessages{ 10000 };
+    RingQueue<int> q(16);
+    Latch latch(5);
+    std::vector<std::vector<int>> consumed(4);
+
+    std::thread prodThr(produce, ref(q), ref(latch), noMessages);
+    std::vector<std::thread> consThrs;
+    for (auto &it : consumed)
+        consThrs.emplace_back(consume, ref(q), ref(latch), ref(it));
+
+    prodThr.join();
+    for (auto &it : consThrs)
+        it.join();
+
+    std::vector<int> expected;
+    for (int i{ 1 }; i <= noMessages; ++i)
+        expected.push_back(i);
+    bool success = true;
+    for (auto &it : consumed)
+        success &= (it == expected);
+    return success;
+}
+
+int test2() {
+    // SECOND TEST
+    // A consumer stops reading and unsubscribes while the ring is full
+    // OUTPUT: the producer is released and the other consumer reads everything
+
+    std::cout << "\n ---------------- Second Test ---------------- \n";
+    std::cout << "OUTPUT:  leaving subscriber does not stall the producer\n\n";
+
+    const int noMessages{ 1000 };
+    RingQueue<int> q(8);
+    Latch latch(3);
+    std::vector<int> consumedAll, consumedSome;
+
+    std::thread prodThr(produce, ref(q), ref(latch), noMessages);
+    std::thread consAllThr(consume, ref(q), ref(latch), ref(consumedAll));
+    std::thread consSomeThr([&]() {
+        q.subscribe();
+        latch.wait();
+        for (int i{ 0 }; i < 5; ++i)
+            consumedSome.push_back(q.pop().value());
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        q.unsubscribe();
+    });
+
+    prodThr.join();
+    consAllThr.join();
+    consSomeThr.join();
+
+    bool success = consumedAll.size() == noMessages;
+    success &= consumedSome == std::vector<int>({ 1, 2, 3, 4, 5 });
+    return success;
+}
+
+int test3() {
+    // THIRD TEST
+    // A subscription is moved onto another live subscription, then the producer sends more
+    // messages than the capacity of the ring
+    // OUTPUT: the overwritten cursor is released, so the producer never waits for it
+
+    std::cout << "\n ---------------- Third Test ---------------- \n";
+    std::cout << "OUTPUT:  100 messages through a ring of 4 after the move\n\n";
+
+    const int noMessages{ 100 };
+    RingQueue<int> q(4);
+    auto reader{ q.subscribe() };
+    auto other{ q.subscribe() };
+    reader = std::move(other);
+    bool success = reader.isSubscribed() && !other.isSubscribed();
+
+    std::thread prodThr([&q, noMessages]() {
+        for (int i{ 1 }; i <= noMessages; ++i)
+            q.push(i);
+        q.close();
+    });
+    int read{ 0 };
+    while (auto val{ reader.pop() })
+        success &= val.value() == ++read;
+    prodThr.join();
+    success &= read == noMessages;
+    return success;
+}
+
+int main() {
+    if (!test1()) {
+        std::cout << "Test1 failed\n";
+        return 1;
+    }
+    if (!test2()) {
+        std::cout << "Test2 failed\n";
+        return 1;
+    }
+    if (!test3()) {
+        std::cout << "Test3 failed\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/Queue.h"
+#include "rtb/concurrency/SimpleQueue.h"
+#include "rtb/concurrency/Selector.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+
+using namespace rtb::Concurrency;
+
+int test1() {
+    // FIRST TEST
+    // A single consumer merges a `Queue<int>` and a `SimpleQueue<std::string>`, fed by two
+    // producers
+    // OUTPUT: the consumer reads all the messages of both queues, each stream in order
+
+    std::cout << "\n ---------------- First Test ---------------- \n";
+    std::cout << "OUTPUT:  one thread reads 1000 markers and 1000 forces\n\n";
+
+    const int noMessages{ 1000 };
+    Queue<int> markers;
+    SimpleQueue<std::string> forces;
+    auto subscription{ markers.subscribe() };
+
+    std::thread markersThr([&]() {
+        for (int i{ 0 }; i < noMessages; ++i)
+            markers.push(i);
+        markers.close();
+    });
+    std::thread forcesThr([&]() {
+        for (int i{ 0 }; i < noMessages; ++i)
+            forces.push(std::to_string(i));
+        forces.close();
+    });
+
+    std::vector<int> readMarkers;
+    std::vector<std::string> readForces;
+    {
+        Selector selector;
+        const size_t markersIdx{ selector.add(subscription) };
+        const size_t forcesIdx{ selector.add(forces) };
+        int open{ 2 };
+        while (open > 0) {
+            const size_t ready{ selector.wait() };
+            if (ready == markersIdx) {
+                if (auto val{ subscription.pop() })
+                    readMarkers.push_back(val.value());
+                else
+                    --open;
+            } else if (ready == forcesIdx) {
+                if (auto val{ forces.pop() })
+                    readForces.push_back(val.value());
+                else
+                    --open;
+            }
+        }
+    }
+    markersThr.join();
+    forcesThr.join();
+
+    bool success = readMarkers.size() == noMessages && readForces.size() == noMessages;
+    for (int i{ 0 }; success && i < noMessages; ++i)
+        success &= readMarkers[i] == i && readForces[i] == std::to_string(i);
+    return success;
+}
+
+int test2() {
+    // SECOND TEST
+    // The consumer waits with a timeout on two empty queues, then a message arrives on the
+    // second one
+    // OUTPUT: the first wait times out, the second returns the index of the second queue
+
+    std::cout << "\n ---------------- Second Test ---------------- \n";
+    std::cout << "OUTPUT:  timeout, then the second queue is ready\n\n";
+
+    SimpleQueue<int> first;
+    Queue<double> second;
+    auto subscription{ second.subscribe() };
+    Selector selector;
+    selector.add(first);
+    selector.add(subscription);
+
+    bool success = !selector.waitFor(std::chrono::milliseconds(20)).has_value();
+    std::thread prodThr([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        second.push(3.14);
+    });
+    auto ready{ selector.waitFor(std::chrono::seconds(5)) };
+    prodThr.join();
+    success &= ready.has_value() && ready.value() == 1;
+    success &= subscription.pop().value() == 3.14;
+    return success;
+}
+
+int main() {
+    if (!test1()) {
+        std::cout << "Test1 failed\n";
+        return 1;
+    }
+    if (!test2()) {
+        std::cout << "Test2 failed\n";
+        return 1;
+    }
+    return 0;
+}
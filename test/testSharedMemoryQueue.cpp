@@ -0,0 +1,190 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/SharedMemoryQueue.h"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <chrono>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace rtb::Concurrency;
+
+struct Frame {
+    int index;
+    double values[8];
+};
+
+// each test uses its own segment, removed first in case a previous run crashed
+std::string segmentName(int test) {
+    std::string name{ "/rtbTestSharedMemoryQueue" + std::to_string(getpid()) + "_"
+                      + std::to_string(test) };
+    SharedMemorySegment::remove(name);
+    return name;
+}
+
+// runs `consumer` in a child process, which has attached to the queue when `waitForChild`
+// returns. Returns the pid of the child
+template<typename Consumer>
+pid_t forkConsumer(Consumer consumer, int &readyPipe) {
+    int fds[2];
+    if (pipe(fds) == -1) return -1;
+    pid_t pid{ fork() };
+    if (pid == 0) {
+        close(fds[0]);
+        _exit(consumer(fds[1]) ? 0 : 1);
+    }
+    close(fds[1]);
+    readyPipe = fds[0];
+    return pid;
+}
+
+void signalReady(int fd) {
+    char ready{ 1 };
+    (void)!write(fd, &ready, 1);
+    close(fd);
+}
+
+void waitForChild(int fd) {
+    char ready;
+    (void)!read(fd, &ready, 1);
+    close(fd);
+}
+
+bool childSucceeded(pid_t pid) {
+    int status{ 0 };
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int test1() {
+    // FIRST TEST
+    // A consumer process opens the queue by name and reads many more messages than the
+    // capacity of the ring
+    // OUTPUT: the consumer reads all the frames, in order, then the end of the stream
+
+    std::cout << "\n ---------------- First Test ---------------- \n";
+    std::cout << "OUTPUT:  a child process reads 10000 frames through a ring of 16\n\n";
+
+    const int noMessages{ 10000 };
+    const auto name{ segmentName(1) };
+    auto q{ SharedMemoryQueue<Frame>::create(name, 16) };
+    int readyPipe{ -1 };
+    pid_t child{ forkConsumer(
+        [&name, noMessages](int ready) {
+            auto attached{ SharedMemoryQueue<Frame>::open(name) };
+            auto subscription{ attached.subscribe() };
+            signalReady(ready);
+            int expected{ 0 };
+            bool ok = true;
+            while (auto frame{ subscription.pop() }) {
+                ok &= frame->index == expected && frame->values[7] == expected * 0.5;
+                ++expected;
+            }
+            subscription.unsubscribe();
+            return ok && expected == noMessages;
+        },
+        readyPipe) };
+    waitForChild(readyPipe);
+    for (int i{ 0 }; i < noMessages; ++i) {
+        Frame frame{};
+        frame.index = i;
+        frame.values[7] = i * 0.5;
+        q.push(frame);
+    }
+    q.close();
+    return childSucceeded(child);
+}
+
+int test2() {
+    // SECOND TEST
+    // A consumer process dies without unsubscribing while the ring is full, then a second
+    // process opens the queue with the wrong type
+    // OUTPUT: the producer is released, the wrong type is refused
+
+    std::cout << "\n ---------------- Second Test ---------------- \n";
+    std::cout << "OUTPUT:  dead subscribers are released, wrong types are refused\n\n";
+
+    const auto name{ segmentName(2) };
+    auto q{ SharedMemoryQueue<int>::create(name, 4) };
+    auto local{ q.subscribe() };
+    int readyPipe{ -1 };
+    pid_t child{ forkConsumer(
+        [&name](int ready) {
+            auto attached{ SharedMemoryQueue<int>::open(name) };
+            auto subscription{ attached.subscribe() };
+            signalReady(ready);
+            return true;
+        },
+        readyPipe) };
+    waitForChild(readyPipe);
+    bool success = childSucceeded(child);
+    for (int i{ 0 }; i < 10; ++i) {
+        q.push(i);
+        int value{ -1 };
+        success &= local.popFor(value, std::chrono::seconds(5)) == PopResult::Ok && value == i;
+    }
+    int value{ 0 };
+    success &= local.popFor(value, std::chrono::milliseconds(10)) == PopResult::Timeout;
+    q.close();
+    success &= local.popFor(value, std::chrono::milliseconds(10)) == PopResult::Closed;
+
+    try {
+        SharedMemoryQueue<double>::open(name);
+        success = false;
+    } catch (const std::runtime_error &) {
+    }
+    return success;
+}
+
+int test3() {
+    // THIRD TEST
+    // A subscription is moved onto another live subscription, then the producer sends more
+    // messages than the capacity of the ring
+    // OUTPUT: the overwritten cursor is released, so the producer never waits for it
+
+    std::cout << "\n ---------------- Third Test ---------------- \n";
+    std::cout << "OUTPUT:  10 messages through a ring of 4 after the move\n\n";
+
+    const auto name{ segmentName(3) };
+    auto q{ SharedMemoryQueue<int>::create(name, 4) };
+    auto reader{ q.subscribe() };
+    auto other{ q.subscribe() };
+    reader = std::move(other);
+    bool success = reader.isSubscribed() && !other.isSubscribed();
+    for (int i{ 0 }; i < 10; ++i) {
+        q.push(i);
+        int value{ -1 };
+        success &= reader.popFor(value, std::chrono::seconds(5)) == PopResult::Ok && value == i;
+    }
+    return success;
+}
+
+int main() {
+    if (!test1()) {
+        std::cout << "Test1 failed\n";
+        return 1;
+    }
+    if (!test2()) {
+        std::cout << "Test2 failed\n";
+        return 1;
+    }
+    if (!test3()) {
+        std::cout << "Test3 failed\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/SimpleQueue.h"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include <memory>
+
+using namespace rtb::Concurrency;
+
+int test1() {
+    // FIRST TEST
+    // The producer pushes batches of messages, two consumers read batches and one close each
+    // OUTPUT: every message is read by exactly one consumer
+
+    std::cout << "\n ---------------- First Test ---------------- \n";
+    std::cout << "OUTPUT:  1000 messages split between 2 consumers\n\n";
+
+    SimpleQueue<int> q;
+    std::vector<int> consumed1, consumed2;
+    auto consume([&q](std::vector<int> &consumed) {
+        while (q.popBatch(std::back_inserter(consumed), 32) > 0) {}
+    });
+
+    std::thread consThr1(consume, std::ref(consumed1));
+    std::thread consThr2(consume, std::ref(consumed2));
+    std::vector<int> batch(100);
+    for (int i{ 0 }; i < 10; ++i) {
+        std::generate(batch.begin(), batch.end(), [n = i * 100]() mutable { return n++; });
+        q.pushRange(batch.begin(), batch.end());
+    }
+    q.close();
+    q.close();
+    consThr1.join();
+    consThr2.join();
+
+    std::vector<int> consumed(consumed1);
+    consumed.insert(consumed.end(), consumed2.begin(), consumed2.end());
+    std::sort(consumed.begin(), consumed.end());
+    bool success = consumed.size() == 1000;
+    for (int i{ 0 }; i < static_cast<int>(consumed.size()); ++i)
+        success &= (consumed[i] == i);
+    success &= q.size() == 0;
+    return success;
+}
+
+int test2() {
+    // SECOND TEST
+    // Non-blocking and timed pops, and timed pop of an index from a sorted queue
+    // OUTPUT: timeouts are reported distinctly from the end of the stream
+
+    std::cout << "\n ---------------- Second Test ---------------- \n";
+    std::cout << "OUTPUT:  tryPop, popFor and popIndexFor report Timeout, Ok and Closed\n\n";
+
+    SimpleQueue<int> q;
+    int value{ 0 };
+    bool success = q.tryPop(value) == PopResult::Timeout;
+    success &= q.popFor(value, std::chrono::milliseconds(10)) == PopResult::Timeout;
+    q.push(7);
+    q.close();
+    success &= (q.tryPop(value) == PopResult::Ok) && (value == 7);
+    success &= q.popFor(value, std::chrono::milliseconds(10)) == PopResult::Closed;
+
+    SortedIndexedDataQueue<double> sorted;
+    sorted.push(IndexedData<double>{ 1, 1.5 });
+    IndexedData<double> data;
+    success &= sorted.popIndexFor(0, data, std::chrono::milliseconds(10)) == PopResult::Timeout;
+    sorted.push(IndexedData<double>{ 0, 0.5 });
+    success &= sorted.popIndexFor(0, data, std::chrono::milliseconds(10)) == PopResult::Ok;
+    success &= std::get<1>(data) == 0.5;
+    success &= sorted.popIndexFor(1, data, std::chrono::milliseconds(10)) == PopResult::Ok;
+    success &= std::get<1>(data) == 1.5;
+    return success;
+}
+
+int test3() {
+    // THIRD TEST
+    // Move-only messages pushed, emplaced and popped one at a time and in a batch
+    // OUTPUT: unique_ptr messages go through the queue in order
+
+    std::cout << "\n ---------------- Third Test ---------------- \n";
+    std::cout << "OUTPUT:  move-only messages are queued and popped in order\n\n";
+
+    SimpleQueue<std::unique_ptr<int>> q;
+    q.push(std::make_unique<int>(1));
+    q.emplace(new int{ 2 });
+    q.push(std::make_unique<int>(3));
+    q.close();
+    bool success = true;
+    auto first{ q.pop() };
+    success &= first && *first.value() == 1;
+    std::vector<std::unique_ptr<int>> rest;
+    success &= q.popBatch(std::back_inserter(rest), 10) == 2;
+    success &= *rest[0] == 2 && *rest[1] == 3;
+    success &= !q.pop();
+    return success;
+}
+
+int main() {
+    if (!test1()) {
+        std::cout << "Test1 failed\n";
+        return 1;
+    }
+    if (!test2()) {
+        std::cout << "Test2 failed\n";
+        return 1;
+    }
+    if (!test3()) {
+        std::cout << "Test3 failed\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/SpscQueue.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+
+using namespace rtb::Concurrency;
+
+int test1() {
+    // FIRST TEST
+    // A producer sends many more messages than the capacity of the ring to a consumer
+    // OUTPUT: the consumer reads all the messages, in order
+
+    std::cout << "\n ---------------- First Test ---------------- \n";
+    std::cout << "OUTPUT:  100000 messages go through a ring of 8\n\n";
+
+    const int noMessages{ 100000 };
+    SpscQueue<int> q(8);
+    std::vector<int> consumed;
+    std::thread consThr([&]() {
+        while (auto val{ q.pop() })
+            consumed.push_back(val.value());
+    });
+    for (int i{ 0 }; i < noMessages; ++i)
+        q.push(i);
+    q.close();
+    consThr.join();
+
+    bool success = consumed.size() == noMessages;
+    for (int i{ 0 }; success && i < noMessages; ++i)
+        success &= consumed[i] == i;
+    return success;
+}
+
+int test2() {
+    // SECOND TEST
+    // Non-blocking and timed calls on an empty, a full and a closed ring
+    // OUTPUT: Timeout when empty, false when full, Closed after close
+
+    std::cout << "\n ---------------- Second Test ---------------- \n";
+    std::cout << "OUTPUT:  timeouts, full ring and end of stream are reported\n\n";
+
+    SpscQueue<std::string> q(2);
+    std::string item;
+    bool success = q.capacity() == 2;
+    success &= q.tryPop(item) == PopResult::Timeout;
+    success &= q.popFor(item, std::chrono::milliseconds(10)) == PopResult::Timeout;
+    std::string first{ "first" };
+    success &= q.tryPush(std::move(first)) && q.tryPush("second");
+    std::string third{ "third" };
+    success &= !q.tryPush(std::move(third)) && third == "third" && q.size() == 2;
+    success &= q.tryPop(item) == PopResult::Ok && item == "first";
+    q.close();
+    success &= q.tryPop(item) == PopResult::Ok && item == "second";
+    success &= q.popFor(item, std::chrono::milliseconds(10)) == PopResult::Closed;
+    return success;
+}
+
+int main() {
+    if (!test1()) {
+        std::cout << "Test1 failed\n";
+        return 1;
+    }
+    if (!test2()) {
+        std::cout << "Test2 failed\n";
+        return 1;
+    }
+    return 0;
+}
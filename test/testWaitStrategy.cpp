@@ -0,0 +1,186 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/Latch.h"
+#include "rtb/concurrency/Queue.h"
+#include "rtb/concurrency/SimpleQueue.h"
+#include "rtb/concurrency/WaitStrategy.h"
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <queue>
+#include <optional>
+#include <functional>
+
+using namespace rtb::Concurrency;
+
+// a wait strategy of the user's, not built into the library: a `BlockingWait` that counts the
+// waits
+class CountingWait {
+  public:
+    CountingWait() = default;
+    CountingWait(const CountingWait &) = delete;
+    CountingWait &operator=(const CountingWait &) = delete;
+    template<typename Predicate>
+    void wait(std::unique_lock<std::mutex> &lock, Predicate ready) {
+        ++waits;
+        cond_.wait(lock, ready);
+    }
+    template<typename Clock, typename Duration, typename Predicate>
+    bool waitUntil(std::unique_lock<std::mutex> &lock,
+        const std::chrono::time_point<Clock, Duration> &deadline,
+        Predicate ready) {
+        ++waits;
+        return cond_.wait_until(lock, deadline, ready);
+    }
+    void notifyOne() { cond_.notify_one(); }
+    void notifyAll() { cond_.notify_all(); }
+    static std::atomic<int> waits;
+
+  private:
+    std::condition_variable cond_;
+};
+
+std::atomic<int> CountingWait::waits{ 0 };
+
+template<typename WaitStrategy>
+bool deliversAll() {
+    const int noMessages{ 2000 };
+    Queue<int, WaitStrategy> q;
+    SimpleQueue<int, std::queue<std::optional<int>, RingBuffer<std::optional<int>>>, WaitStrategy>
+        simple;
+    BasicLatch<WaitStrategy> latch(4);
+    std::vector<int> consumed1, consumed2, consumedSimple;
+
+    std::thread prodThr([&]() {
+        latch.wait();
+        for (int i{ 0 }; i < noMessages; ++i) {
+            q.push(i);
+            simple.push(i);
+        }
+        q.close();
+        simple.close();
+    });
+    auto consume = [&](std::vector<int> &consumed) {
+        auto subscription{ q.subscribe() };
+        latch.wait();
+        while (auto val{ subscription.pop() })
+            consumed.push_back(val.value());
+    };
+    std::thread consThr1(consume, std::ref(consumed1));
+    std::thread consThr2(consume, std::ref(consumed2));
+    std::thread simpleThr([&]() {
+        latch.wait();
+        while (auto val{ simple.pop() })
+            consumedSimple.push_back(val.value());
+    });
+    prodThr.join();
+    consThr1.join();
+    consThr2.join();
+    simpleThr.join();
+
+    std::vector<int> expected;
+    for (int i{ 0 }; i < noMessages; ++i)
+        expected.push_back(i);
+    return consumed1 == expected && consumed2 == expected && consumedSimple == expected;
+}
+
+template<typename WaitStrategy>
+bool timesOutAndBlocks() {
+    Queue<int, WaitStrategy> q(4);
+    auto subscription{ q.subscribe() };
+    int value{ 0 };
+    auto start{ std::chrono::steady_clock::now() };
+    bool success = subscription.popFor(value, std::chrono::milliseconds(10)) == PopResult::Timeout;
+    success &= (std::chrono::steady_clock::now() - start) >= std::chrono::milliseconds(10);
+
+    // the producer blocks on the full queue until the subscriber makes room
+    std::thread prodThr([&]() {
+        for (int i{ 0 }; i < 100; ++i)
+            q.push(i);
+        q.close();
+    });
+    int expected{ 0 };
+    while (auto val{ subscription.pop() })
+        success &= (val.value() == expected++);
+    prodThr.join();
+    success &= (expected == 100);
+
+    SimpleQueue<int, std::queue<std::optional<int>, RingBuffer<std::optional<int>>>, WaitStrategy>
+        simple;
+    success &= simple.popFor(value, std::chrono::milliseconds(10)) == PopResult::Timeout;
+    return success;
+}
+
+int test1() {
+    // FIRST TEST
+    // A producer and three consumers, started by a latch, with each wait strategy
+    // OUTPUT: all the consumers read all the messages, in order
+
+    std::cout << "\n ---------------- First Test ---------------- \n";
+    std::cout << "OUTPUT:  Queue, SimpleQueue and BasicLatch work with every wait strategy\n\n";
+
+    bool success = deliversAll<BlockingWait>();
+    success &= deliversAll<SpinThenParkWait>();
+    success &= deliversAll<YieldWait>();
+    success &= deliversAll<BusySpinWait>();
+    return success;
+}
+
+int test2() {
+    // SECOND TEST
+    // Timed pops on empty queues, and a producer blocked by a bounded queue
+    // OUTPUT: the pops time out, the producer is released when there is room
+
+    std::cout << "\n ---------------- Second Test ---------------- \n";
+    std::cout << "OUTPUT:  timeouts and blocked producers with every wait strategy\n\n";
+
+    bool success = timesOutAndBlocks<BlockingWait>();
+    success &= timesOutAndBlocks<SpinThenParkWait>();
+    success &= timesOutAndBlocks<YieldWait>();
+    success &= timesOutAndBlocks<BusySpinWait>();
+    return success;
+}
+
+int test3() {
+    // THIRD TEST
+    // As the first test, with a wait strategy defined by the user
+    // OUTPUT: all the consumers read all the messages, in order, waiting through the strategy
+
+    std::cout << "\n ---------------- Third Test ---------------- \n";
+    std::cout << "OUTPUT:  Queue, SimpleQueue and BasicLatch work with a user wait strategy\n\n";
+
+    bool success = deliversAll<CountingWait>();
+    std::cout << CountingWait::waits << " waits\n";
+    return success && CountingWait::waits > 0;
+}
+
+int main() {
+    if (!test1()) {
+        std::cout << "Test1 failed\n";
+        return 1;
+    }
+    if (!test2()) {
+        std::cout << "Test2 failed\n";
+        return 1;
+    }
+    if (!test3()) {
+        std::cout << "Test3 failed\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,123 @@
+/* -------------------------------------------------------------------------- *
+ * Copyright (c) 2020      C. Pizzolato, M. Reggiani                          *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License");            *
+ * you may not use this file except in compliance with the License.           *
+ * You may obtain a copy of the License at:                                   *
+ * http://www.apache.org/licenses/LICENSE-2.0                                 *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "rtb/concurrency/WorkerPool.h"
+#include "rtb/concurrency/Latch.h"
+#include "rtb/concurrency/ThreadPool.h"
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace rtb::Concurrency;
+
+struct AddOne {
+    using InputData = double;
+    using OutputData = double;
+    double operator()(double value) { return value + 1.; }
+};
+
+// the threads go back to idle just after their work is done, a piece of work posted before
+// would get a new thread
+void waitIdle(const WorkerPool &workerPool) {
+    while (workerPool.idle() < workerPool.size())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+int test1() {
+    // FIRST TEST
+    // Work that waits for the other work posted with it, first within the pre-spawned threads
+    // then beyond them
+    // OUTPUT: the pool spawns the missing threads only, and keeps them
+
+    std::cout << "\n ---------------- First Test ---------------- \n";
+    std::cout << "OUTPUT:  2 pre-spawned threads, grown to 6, still 6 after the work is done\n\n";
+
+    WorkerPool workerPool(2);
+    bool success = workerPool.size() == 2;
+    for (std::size_t noWork : { 2, 6, 3 }) {
+        waitIdle(workerPool);
+        // each piece of work returns only when all of them run at once
+        Latch together(static_cast<int>(noWork));
+        WaitGroup done(noWork);
+        struct Args {
+            Latch &together;
+            WaitGroup &done;
+        } args{ together, done };
+        for (std::size_t i{ 0 }; i < noWork; ++i)
+            workerPool.post(
+                [](void *arg) {
+                    auto &args{ *static_cast<Args *>(arg) };
+                    args.together.wait();
+                    args.done.done();
+                },
+                &args);
+        done.wait();
+        std::cout << noWork << " pieces of work, " << workerPool.size() << " threads\n";
+    }
+    success &= workerPool.size() == 6;
+    workerPool.join();
+    success &= workerPool.size() == 0;
+    return success;
+}
+
+int test2() {
+    // SECOND TEST
+    // Three execution pools run one after the other on the same worker pool
+    // OUTPUT: all the messages are published in order, by the threads spawned for the first run
+
+    std::cout << "\n ---------------- Second Test ---------------- \n";
+    std::cout << "OUTPUT:  3 runs of 100 messages on 5 threads\n\n";
+
+    const int noMessages{ 100 };
+    const unsigned noWorkers{ 3 };
+    WorkerPool workerPool(noWorkers + 2);
+    bool success = true;
+    for (int run{ 0 }; run < 3; ++run) {
+        waitIdle(workerPool);
+        Queue<double> inputQueue, outputQueue;
+        auto sink{ outputQueue.subscribe() };
+        auto pool(makeExecutionPool(inputQueue, outputQueue, noWorkers, workerPool));
+        std::thread poolThr(std::ref(*pool), AddOne{});
+        std::thread sourceThr([&]() {
+            // leaves time to the pool to subscribe to its input
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            for (int i{ 0 }; i < noMessages; ++i)
+                inputQueue.push(i);
+            inputQueue.close();
+        });
+        int received{ 0 };
+        while (auto val{ sink.pop() })
+            success &= val.value() == ++received;
+        sourceThr.join();
+        poolThr.join();
+        success &= received == noMessages;
+        std::cout << "run " << run << ": " << received << " messages, " << workerPool.size()
+                  << " threads\n";
+    }
+    success &= workerPool.size() == noWorkers + 2;
+    return success;
+}
+
+int main() {
+    if (!test1()) {
+        std::cout << "Test1 failed\n";
+        return 1;
+    }
+    if (!test2()) {
+        std::cout << "Test2 failed\n";
+        return 1;
+    }
+    return 0;
+}